@@ -1,74 +1,235 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <new>
 #include <random>
 #include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <iostream>
 
+#include "../19/Reclamation.h"
+#include "../20/Benchmark.h"
+
+// A node is a single block: the key, the height of its tower, then `level` forward links laid out
+// inline after the struct, so a hop reads the key and the next link from the same cache lines.
+// back is the level-0 predecessor, which lets iterators step backwards.
 template <typename T>
 struct Node {
     T key;
-    std::vector<std::shared_ptr<Node>> forward;
-    Node(T key, size_t level) : key {std::move(key)} {
-        forward.resize(level + 1);
+    size_t level;
+    Node* back;
+
+    Node(T key, size_t level) : key {std::move(key)}, level {level}, back {nullptr} {
+        std::uninitialized_fill_n(forward(), level, nullptr);
+    }
+
+    Node** forward() noexcept {
+        return std::launder(reinterpret_cast<Node**>(reinterpret_cast<std::byte*>(this) + linksOffset()));
+    }
+
+    Node* const* forward() const noexcept {
+        return const_cast<Node*>(this)->forward();
+    }
+
+    static constexpr size_t linksOffset() noexcept {
+        return (sizeof(Node) + alignof(Node*) - 1) & ~(alignof(Node*) - 1);
+    }
+
+    static constexpr size_t bytes(size_t level) noexcept {
+        return linksOffset() + level * sizeof(Node*);
     }
 };
 
-std::mt19937 gen(std::random_device{}());
+// Bump allocator for skip list nodes of type N, which must have a `level` member and a static bytes(level)
+// giving the size of a node with that many links. Freed nodes are kept on one free list per tower height,
+// so a later node of the same height reuses the block; chunks are only returned when the arena dies.
+template <typename N>
+class NodeArena {
+    static constexpr size_t ChunkBytes = 64 * 1024;
+    static constexpr size_t Align = std::max(alignof(N), alignof(void*));
 
-template <typename T>
-size_t node_level(const std::vector<std::shared_ptr<Node<T>>>& floor) {
-    size_t level = 1;
-    if (floor.front() && floor.front()->key == std::numeric_limits<T>::max()) {
-        return level;
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::vector<std::byte*> chunks;
+    std::vector<FreeBlock*> freeLists;
+    std::byte* cursor = nullptr;
+    std::byte* chunkEnd = nullptr;
+    size_t live = 0;
+    size_t reserved = 0;
+
+public:
+    explicit NodeArena(size_t maxLevel) : freeLists(maxLevel + 1, nullptr) {}
+
+    static size_t blockBytes(size_t level) noexcept {
+        size_t b = std::max(N::bytes(level), sizeof(FreeBlock));
+        return (b + Align - 1) & ~(Align - 1);
     }
-    for (const auto& node : floor) {
-        if (node && node->key != std::numeric_limits<T>::max()) {
-            level++;
-        } else {
-            break;
+
+    // Makes the next `bytes` worth of fresh blocks come from one chunk, back to back.
+    void reserve(size_t bytes) {
+        if (cursor == nullptr || static_cast<size_t>(chunkEnd - cursor) < bytes) {
+            grow(bytes);
         }
     }
-    return level;
-}
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    ~NodeArena() {
+        for (auto* c : chunks) {
+            ::operator delete(c, std::align_val_t {Align});
+        }
+    }
+
+    // Builds N(args..., level) in a block with room for level links.
+    template <typename... Args>
+    N* create(size_t level, Args&&... args) {
+        if (FreeBlock* b = freeLists[level]) {
+            FreeBlock* next = b->next;
+            N* node = ::new (static_cast<void*>(b)) N(std::forward<Args>(args)..., level);
+            freeLists[level] = next;
+            live++;
+            return node;
+        }
+        return append(level, std::forward<Args>(args)...);
+    }
+
+    // Like create, but always carves a fresh block, so consecutive calls lay nodes out back to back.
+    template <typename... Args>
+    N* append(size_t level, Args&&... args) {
+        size_t n = blockBytes(level);
+        if (cursor == nullptr || static_cast<size_t>(chunkEnd - cursor) < n) {
+            grow(n);
+        }
+        N* node = ::new (static_cast<void*>(cursor)) N(std::forward<Args>(args)..., level);
+        cursor += n;
+        reserved += n;
+        live++;
+        return node;
+    }
+
+    void destroy(N* node) noexcept {
+        size_t level = node->level;
+        node->~N();
+        auto* b = ::new (static_cast<void*>(node)) FreeBlock {freeLists[level]};
+        freeLists[level] = b;
+        live--;
+    }
+
+    // Bytes handed out for nodes so far, live or on a free list.
+    size_t bytesReserved() const noexcept {
+        return reserved;
+    }
+
+    size_t liveNodes() const noexcept {
+        return live;
+    }
+
+private:
+    void grow(size_t n) {
+        size_t bytes = std::max(ChunkBytes, n);
+        chunks.reserve(chunks.size() + 1);
+        cursor = static_cast<std::byte*>(::operator new(bytes, std::align_val_t {Align}));
+        chunkEnd = cursor + bytes;
+        chunks.push_back(cursor);
+    }
+};
+
+std::mt19937 gen(std::random_device{}());
+
+enum class LevelAssignment {
+    Random,
+    Deterministic
+};
 
 template <typename T>
 struct SkipList {
+    static constexpr size_t MaxLevels = 32;
+
     size_t levels;
     float prob;
     size_t curr_level;
-    std::shared_ptr<Node<T>> head;
-    std::shared_ptr<Node<T>> NIL;
+    NodeArena<Node<T>> arena;
+    Node<T>* head;
+    // A level is added while a draw from gen falls below this, i.e. with probability prob.
+    uint32_t promote;
 
-    SkipList(size_t levels, float prob) : levels {levels}, prob {prob} {
-        curr_level = 0;
-        head = std::make_shared<Node<T>>(std::numeric_limits<T>::min(), levels);
-        NIL = std::make_shared<Node<T>>(std::numeric_limits<T>::max(), levels);
-        for (auto& pred : head->forward) {
-            pred = NIL;
+    SkipList(size_t levels, float prob) : levels {levels}, prob {prob}, curr_level {0}, arena {levels},
+                                          promote {static_cast<uint32_t>(std::min(std::ldexp(double {prob}, 32), 4294967295.0))} {
+        assert(levels > 0 && levels <= MaxLevels);
+        head = arena.create(levels, T {});
+    }
+
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
+
+    ~SkipList() {
+        Node<T>* curr = head;
+        while (curr) {
+            Node<T>* next = curr->forward()[0];
+            arena.destroy(curr);
+            curr = next;
         }
     }
 
     size_t random_level() {
         size_t level = 1;
-        std::uniform_real_distribution<> dis(0.0, 1.0);
-        while (dis(gen) < prob && level < levels) {
+        while (gen() < promote && level < levels) {
             level++;
         }
         return level;
     }
 
-    std::shared_ptr<Node<T>> search(const T& key) {
-        auto curr = head;
-        size_t curr_max = node_level(head->forward);
-        for (size_t i = curr_max; i-- > 0;) {
-            while (curr->forward[i] && curr->forward[i]->key < key) {
-                curr = curr->forward[i];
+    // Leaves in update[i] the last node on level i whose key is less than key.
+    Node<T>* find_predecessors(const T& key, Node<T>** update) const {
+        Node<T>* curr = head;
+        for (size_t i = curr_level; i-- > 0;) {
+            Node<T>* next;
+            while ((next = curr->forward()[i]) && next->key < key) {
+                curr = next;
+            }
+            update[i] = curr;
+        }
+        return curr->forward()[0];
+    }
+
+    Node<T>* search(const T& key) const {
+        Node<T>* curr = head;
+        for (size_t i = curr_level; i-- > 0;) {
+            Node<T>* next;
+            while ((next = curr->forward()[i]) && next->key < key) {
+                curr = next;
             }
         }
-        curr = curr->forward.front();
-        if (curr->key == key) {
+        curr = curr->forward()[0];
+        if (curr && curr->key == key) {
             return curr;
         } else {
             return nullptr;
@@ -76,69 +237,304 @@ struct SkipList {
     }
 
     void insert(const T& key) {
-        auto curr = search(key);
-        if (curr) return;
+        Node<T>* update[MaxLevels];
+        Node<T>* curr = find_predecessors(key, update);
+        if (curr && curr->key == key) {
+            return;
+        }
+        size_t new_level = random_level();
+        for (size_t i = curr_level; i < new_level; ++i) {
+            update[i] = head;
+        }
+        curr_level = std::max(curr_level, new_level);
+        curr = arena.create(new_level, key);
+        for (size_t i = 0; i < new_level; ++i) {
+            curr->forward()[i] = update[i]->forward()[i];
+            update[i]->forward()[i] = curr;
+        }
+        curr->back = update[0];
+        if (Node<T>* next = curr->forward()[0]) {
+            next->back = curr;
+        }
+    }
 
-        std::vector<std::shared_ptr<Node<T>>> update(head->forward);
-        size_t curr_max = node_level(head->forward);
-        curr = head;
-        for (size_t i = curr_max; i-- > 0;) {
-            while (curr->forward[i] && curr->forward[i]->key < key) {
-                curr = curr->forward[i];
+    // Replaces the contents with the keys of a sorted range in one linear pass: towers are linked left to
+    // right through the last node seen on each level, with no descents. Duplicates are dropped.
+    // The levels are chosen up front, so every node is carved from a single arena chunk in key order.
+    // Deterministic gives node i (from 1) one extra level for each time round(1 / prob) divides i,
+    // which is a perfectly balanced list.
+    template <typename ForwardIt>
+    void buildFromSorted(ForwardIt first, ForwardIt last, LevelAssignment assignment = LevelAssignment::Random) {
+        assert(std::is_sorted(first, last));
+        clear();
+        std::vector<unsigned char> heights;
+        heights.reserve(static_cast<size_t>(std::distance(first, last)));
+        size_t step = std::max<size_t>(2, static_cast<size_t>(std::lround(1.0 / prob)));
+        size_t bytes = 0;
+        for (ForwardIt it = first, prev = last; it != last; prev = it++) {
+            if (prev != last && !(*prev < *it)) {
+                continue;
             }
-            update[i] = curr;
+            size_t level = 1;
+            if (assignment == LevelAssignment::Deterministic) {
+                for (size_t i = heights.size() + 1; i % step == 0 && level < levels; i /= step) {
+                    level++;
+                }
+            } else {
+                level = random_level();
+            }
+            heights.push_back(static_cast<unsigned char>(level));
+            bytes += NodeArena<Node<T>>::blockBytes(level);
         }
-        curr = curr->forward.front();
-        size_t new_level = 1;
-        if (curr->key != key) {
-            new_level = random_level();
-            size_t current_level = node_level(update);
+        arena.reserve(bytes);
 
-            if (new_level > current_level) {
-                for (size_t i = current_level + 1; i < new_level; ++i) {
-                    update[i] = head;
-                }
+        Node<T>* tails[MaxLevels];
+        std::fill_n(tails, levels, head);
+        auto height = heights.begin();
+        for (ForwardIt it = first, prev = last; it != last; prev = it++) {
+            if (prev != last && !(*prev < *it)) {
+                continue;
+            }
+            size_t level = *height++;
+            Node<T>* node = arena.append(level, *it);
+            node->back = tails[0];
+            for (size_t i = 0; i < level; ++i) {
+                tails[i]->forward()[i] = node;
+                tails[i] = node;
             }
-            curr = std::make_shared<Node<T>>(key, new_level);
+            curr_level = std::max(curr_level, level);
         }
-        for (size_t i = 0; i < new_level; ++i) {
-            curr->forward[i] = update[i]->forward[i];
-            update[i]->forward[i] = curr;
+    }
+
+    void clear() noexcept {
+        Node<T>* curr = head->forward()[0];
+        while (curr) {
+            Node<T>* next = curr->forward()[0];
+            arena.destroy(curr);
+            curr = next;
         }
+        std::fill_n(head->forward(), levels, nullptr);
+        curr_level = 0;
     }
 
     void erase(const T& key) {
-        std::vector<std::shared_ptr<Node<T>>> update(head->forward);
-        size_t curr_max = node_level(head->forward);
-        auto curr = head;
-        for (size_t i = curr_max; i-- > 0; ) {
-            while (curr->forward[i] && curr->forward[i]->key < key) {
-                curr = curr->forward[i];
+        Node<T>* update[MaxLevels];
+        Node<T>* curr = find_predecessors(key, update);
+        if (curr && curr->key == key) {
+            for (size_t i = 0; i < curr->level; ++i) {
+                update[i]->forward()[i] = curr->forward()[i];
+            }
+            if (Node<T>* next = curr->forward()[0]) {
+                next->back = update[0];
+            }
+            arena.destroy(curr);
+            while (curr_level > 0 && !head->forward()[curr_level - 1]) {
+                curr_level--;
             }
-            update[i] = curr;
         }
-        curr = curr->forward.front();
-        if (curr->key == key) {
-            for (size_t i = 0; i < update.size(); ++i) {
-                if (update[i]->forward[i] != curr) {
-                    break;
+    }
+
+    size_t size() const noexcept {
+        return arena.liveNodes() - 1;
+    }
+
+    // Walks level 0 in key order. end() is the null link, and decrementing it finds the last node.
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept = default;
+
+        reference operator*() const noexcept {
+            return node->key;
+        }
+
+        pointer operator->() const noexcept {
+            return &node->key;
+        }
+
+        const_iterator& operator++() noexcept {
+            node = node->forward()[0];
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator t = *this;
+            ++*this;
+            return t;
+        }
+
+        const_iterator& operator--() noexcept {
+            node = node ? node->back : list->last();
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            const_iterator t = *this;
+            --*this;
+            return t;
+        }
+
+        friend bool operator==(const const_iterator& x, const const_iterator& y) noexcept {
+            return x.node == y.node;
+        }
+
+    private:
+        friend struct SkipList;
+
+        const SkipList* list = nullptr;
+        const Node<T>* node = nullptr;
+
+        const_iterator(const SkipList* list, const Node<T>* node) noexcept : list {list}, node {node} {}
+    };
+
+    using iterator = const_iterator;
+
+    // The keys in [lo, hi), read off level 0 by a cursor that prefetches ahead of itself. Level 0 only ever
+    // yields the next address, so the cursor also keeps a pointer Lookahead nodes along the level-1 express
+    // lane and moves it one hop each time it passes a level-1 node. Each hop prefetches the new lane node and
+    // the level-0 successor of the old one, so several misses are in flight instead of one.
+    class Range {
+    public:
+        static constexpr size_t Lookahead = 8;
+
+        class cursor {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            cursor() noexcept = default;
+
+            reference operator*() const noexcept {
+                return node->key;
+            }
+
+            pointer operator->() const noexcept {
+                return &node->key;
+            }
+
+            cursor& operator++() noexcept {
+                node = node->forward()[0];
+                if (ahead && node && node->level > 1) {
+                    __builtin_prefetch(ahead->forward()[0]);
+                    ahead = ahead->forward()[1];
+                    __builtin_prefetch(ahead);
+                }
+                return *this;
+            }
+
+            cursor operator++(int) noexcept {
+                cursor t = *this;
+                ++*this;
+                return t;
+            }
+
+            friend bool operator==(const cursor& x, const cursor& y) noexcept {
+                return x.node == y.node;
+            }
+
+            friend bool operator==(const cursor& x, std::default_sentinel_t) noexcept {
+                return !x.node || !(x.node->key < *x.hi);
+            }
+
+        private:
+            friend class Range;
+
+            const Node<T>* node = nullptr;
+            const Node<T>* ahead = nullptr;
+            const T* hi = nullptr;
+
+            cursor(const Node<T>* node, const T* hi) noexcept : node {node}, ahead {node}, hi {hi} {
+                while (ahead && ahead->level == 1) {
+                    ahead = ahead->forward()[0];
                 }
-                update[i]->forward[i] = curr->forward[i];
+                for (size_t i = 0; i < Lookahead && ahead; ++i) {
+                    ahead = ahead->forward()[1];
+                    __builtin_prefetch(ahead);
+                }
+            }
+        };
+
+        cursor begin() const noexcept {
+            return cursor(first, &hi);
+        }
+
+        std::default_sentinel_t end() const noexcept {
+            return std::default_sentinel;
+        }
+
+    private:
+        friend struct SkipList;
+
+        const Node<T>* first;
+        T hi;
+
+        Range(const Node<T>* first, T hi) : first {first}, hi {std::move(hi)} {}
+    };
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, head->forward()[0]);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, nullptr);
+    }
+
+    // First key not less than key.
+    const_iterator lower_bound(const T& key) const {
+        Node<T>* curr = head;
+        for (size_t i = curr_level; i-- > 0;) {
+            Node<T>* next;
+            while ((next = curr->forward()[i]) && next->key < key) {
+                curr = next;
             }
-            curr = nullptr;
         }
+        return const_iterator(this, curr->forward()[0]);
+    }
+
+    // First key greater than key.
+    const_iterator upper_bound(const T& key) const {
+        Node<T>* curr = head;
+        for (size_t i = curr_level; i-- > 0;) {
+            Node<T>* next;
+            while ((next = curr->forward()[i]) && !(key < next->key)) {
+                curr = next;
+            }
+        }
+        return const_iterator(this, curr->forward()[0]);
+    }
+
+    // One descent to lo, then a sequential walk; the Range does not stay valid across an erase of its keys.
+    Range range(const T& lo, const T& hi) const {
+        return Range(lower_bound(lo).node, hi);
+    }
+
+    Node<T>* last() const noexcept {
+        Node<T>* curr = head;
+        for (size_t i = curr_level; i-- > 0;) {
+            while (curr->forward()[i]) {
+                curr = curr->forward()[i];
+            }
+        }
+        return curr == head ? nullptr : curr;
     }
 };
 
 template <typename T>
 std::ostream& operator<< (std::ostream& ostr, const SkipList<T>& skipList) {
-    auto head = skipList.head;
+    const Node<T>* curr = skipList.head->forward()[0];
     ostr << "{";
-    while (head->forward.front()) {
-        ostr << "Key : " << head->forward.front()->key
-        << ", Level : " << node_level(head->forward);
-        head = head->forward.front();
-        if (head->forward.front()) {
+    while (curr) {
+        ostr << "Key : " << curr->key << ", Level : " << curr->level;
+        curr = curr->forward()[0];
+        if (curr) {
             ostr << "\n";
         }
     }
@@ -146,22 +542,2027 @@ std::ostream& operator<< (std::ostream& ostr, const SkipList<T>& skipList) {
     return ostr;
 }
 
-int main() {
-    SkipList<int> skipList(16, 0.5);
+// Packs the first eight bytes of a string big-endian, zero-padded. When two prefixes differ they order
+// the strings as std::string's operator< does; only equal prefixes need the strings themselves.
+inline uint64_t keyPrefix(std::string_view s) noexcept {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < std::min<size_t>(s.size(), 8); ++i) {
+        prefix |= uint64_t {static_cast<unsigned char>(s[i])} << (56 - 8 * i);
+    }
+    return prefix;
+}
 
-    for (int i = 0; i < 10; i++) {
-        skipList.insert(i);
+// Whether a SkipListMap<K, V, Compare> can order its keys by keyPrefix first.
+template <typename K, typename Compare>
+inline constexpr bool prefixOrdered = std::is_same_v<K, std::string> &&
+    (std::is_same_v<Compare, std::less<std::string>> || std::is_same_v<Compare, std::less<>>);
+
+struct NoPrefix {};
+
+// Node of a SkipListMap. The entry is stored in the node block, so a short std::string key sits in its
+// small-string buffer right next to the links. Prefix-ordered maps also copy the first eight key bytes
+// into the node, just before the links, so most steps on the way down read one place and never touch
+// a long key's heap buffer. The head sentinel has links but no entry; the map builds and destroys entries itself.
+template <typename K, typename V, bool Prefixed>
+struct MapNode {
+    using value_type = std::pair<const K, V>;
+
+    union {
+        value_type value;
+    };
+    size_t level;
+    [[no_unique_address]] std::conditional_t<Prefixed, uint64_t, NoPrefix> prefix;
+
+    explicit MapNode(size_t level) : level {level}, prefix {} {
+        std::uninitialized_fill_n(forward(), level, nullptr);
     }
-    std::cout << skipList;
 
-    auto five = skipList.search(5);
-    assert(five);
+    ~MapNode() {}
 
-    skipList.insert(8);
-    std::cout << skipList;
+    MapNode** forward() noexcept {
+        return std::launder(reinterpret_cast<MapNode**>(reinterpret_cast<std::byte*>(this) + linksOffset()));
+    }
+
+    MapNode* const* forward() const noexcept {
+        return const_cast<MapNode*>(this)->forward();
+    }
+
+    static constexpr size_t linksOffset() noexcept {
+        return (sizeof(MapNode) + alignof(MapNode*) - 1) & ~(alignof(MapNode*) - 1);
+    }
+
+    static constexpr size_t bytes(size_t level) noexcept {
+        return linksOffset() + level * sizeof(MapNode*);
+    }
+};
+
+// Ordered map on a skip list. Keys need only Compare, not numeric_limits: the head is a sentinel without
+// an entry and the lists end in nullptr. Insertion is one descent that also finds the duplicate, if any.
+// With a transparent Compare, find, contains, count, lower_bound, upper_bound and erase accept any key
+// type Compare can order against K, e.g. std::string_view against std::string without building a string.
+template <typename K, typename V, typename Compare = std::less<K>>
+class SkipListMap {
+    static constexpr bool Prefixed = prefixOrdered<K, Compare>;
+    using MNode = MapNode<K, V, Prefixed>;
+
+    template <typename Key>
+    static constexpr bool usesPrefix = Prefixed && std::is_convertible_v<const Key&, std::string_view>;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using key_compare = Compare;
+    using size_type = size_t;
+
+    static constexpr size_t MaxLevels = 32;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = SkipListMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+        Iterator() noexcept = default;
+
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        Iterator(const Iterator<false>& it) noexcept : node {it.node} {}
+
+        reference operator*() const noexcept {
+            return node->value;
+        }
+
+        pointer operator->() const noexcept {
+            return &node->value;
+        }
+
+        Iterator& operator++() noexcept {
+            node = node->forward()[0];
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator t = *this;
+            ++*this;
+            return t;
+        }
+
+        friend bool operator==(const Iterator& x, const Iterator& y) noexcept {
+            return x.node == y.node;
+        }
+
+    private:
+        friend class SkipListMap;
+        template <bool> friend class Iterator;
+
+        MNode* node = nullptr;
+
+        explicit Iterator(MNode* node) noexcept : node {node} {}
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    explicit SkipListMap(size_t levels = 20, float prob = 0.5, const Compare& comp = Compare())
+        : levels {levels}, curr_level {0}, entries {0}, comp {comp}, arena {levels},
+          promote {static_cast<uint32_t>(std::min(std::ldexp(double {prob}, 32), 4294967295.0))} {
+        assert(levels > 0 && levels <= MaxLevels);
+        head = arena.create(levels);
+    }
+
+    SkipListMap(const SkipListMap&) = delete;
+    SkipListMap& operator=(const SkipListMap&) = delete;
+
+    ~SkipListMap() {
+        clear();
+        arena.destroy(head);
+    }
+
+    iterator begin() noexcept {
+        return iterator(head->forward()[0]);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(head->forward()[0]);
+    }
+
+    iterator end() noexcept {
+        return iterator(nullptr);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(nullptr);
+    }
+
+    size_type size() const noexcept {
+        return entries;
+    }
+
+    bool empty() const noexcept {
+        return entries == 0;
+    }
+
+    key_compare key_comp() const {
+        return comp;
+    }
+
+    iterator find(const K& key) {
+        return iterator(find_node(key));
+    }
+
+    const_iterator find(const K& key) const {
+        return const_iterator(find_node(key));
+    }
+
+    template <typename Key, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const Key& key) {
+        return iterator(find_node(key));
+    }
+
+    template <typename Key, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const Key& key) const {
+        return const_iterator(find_node(key));
+    }
+
+    bool contains(const K& key) const {
+        return find_node(key) != nullptr;
+    }
+
+    template <typename Key, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const Key& key) const {
+        return find_node(key) != nullptr;
+    }
+
+    size_type count(const K& key) const {
+        return contains(key);
+    }
+
+    template <typename Key, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const Key& key) const {
+        return contains(key);
+    }
+
+    iterator lower_bound(const K& key) {
+        return iterator(descend(key, nullptr));
+    }
+
+    const_iterator lower_bound(const K& key) const {
+        return const_iterator(descend(key, nullptr));
+    }
+
+    template <typename Key, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const Key& key) const {
+        return const_iterator(descend(key, nullptr));
+    }
+
+    const_iterator upper_bound(const K& key) const {
+        return const_iterator(upper_node(key));
+    }
+
+    template <typename Key, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const Key& key) const {
+        return const_iterator(upper_node(key));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return emplace_key(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return emplace_key(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return emplace_key(value.first, std::move(value.second));
+    }
+
+    V& operator[](const K& key) {
+        return emplace_key(key).first->second;
+    }
+
+    V& operator[](K&& key) {
+        return emplace_key(std::move(key)).first->second;
+    }
+
+    size_type erase(const K& key) {
+        return erase_key(key);
+    }
+
+    template <typename Key, typename C = Compare, typename = typename C::is_transparent>
+    size_type erase(const Key& key) {
+        return erase_key(key);
+    }
+
+    void clear() noexcept {
+        MNode* curr = head->forward()[0];
+        while (curr) {
+            MNode* next = curr->forward()[0];
+            std::destroy_at(&curr->value);
+            arena.destroy(curr);
+            curr = next;
+        }
+        std::fill_n(head->forward(), levels, nullptr);
+        curr_level = 0;
+        entries = 0;
+    }
+
+private:
+    size_t levels;
+    size_t curr_level;
+    size_t entries;
+    [[no_unique_address]] Compare comp;
+    NodeArena<MNode> arena;
+    MNode* head;
+    uint32_t promote;
+
+    template <typename Key>
+    static auto prefix_of(const Key& key) noexcept {
+        if constexpr (usesPrefix<Key>) {
+            return keyPrefix(std::string_view(key));
+        } else {
+            return NoPrefix {};
+        }
+    }
+
+    // Whether node's key orders before key.
+    template <typename Key, typename Prefix>
+    bool before(const MNode* node, const Key& key, Prefix prefix) const {
+        if constexpr (usesPrefix<Key>) {
+            if (node->prefix != prefix) {
+                return node->prefix < prefix;
+            }
+        }
+        return comp(node->value.first, key);
+    }
+
+    // Whether key orders before node's key.
+    template <typename Key, typename Prefix>
+    bool after(const MNode* node, const Key& key, Prefix prefix) const {
+        if constexpr (usesPrefix<Key>) {
+            if (node->prefix != prefix) {
+                return prefix < node->prefix;
+            }
+        }
+        return comp(key, node->value.first);
+    }
+
+    // Returns the first node not ordered before key, leaving in update[i], if given,
+    // the last node on level i that is.
+    template <typename Key>
+    MNode* descend(const Key& key, MNode** update) const {
+        auto prefix = prefix_of(key);
+        MNode* curr = head;
+        for (size_t i = curr_level; i-- > 0;) {
+            MNode* next;
+            while ((next = curr->forward()[i]) && before(next, key, prefix)) {
+                curr = next;
+            }
+            if (update) {
+                update[i] = curr;
+            }
+        }
+        return curr->forward()[0];
+    }
+
+    template <typename Key>
+    MNode* find_node(const Key& key) const {
+        MNode* node = descend(key, nullptr);
+        return node && !after(node, key, prefix_of(key)) ? node : nullptr;
+    }
+
+    template <typename Key>
+    MNode* upper_node(const Key& key) const {
+        auto prefix = prefix_of(key);
+        MNode* curr = head;
+        for (size_t i = curr_level; i-- > 0;) {
+            MNode* next;
+            while ((next = curr->forward()[i]) && !after(next, key, prefix)) {
+                curr = next;
+            }
+        }
+        return curr->forward()[0];
+    }
+
+    size_t random_level() {
+        size_t level = 1;
+        while (gen() < promote && level < levels) {
+            level++;
+        }
+        return level;
+    }
+
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> emplace_key(Key&& key, Args&&... args) {
+        MNode* update[MaxLevels];
+        auto prefix = prefix_of(key);
+        MNode* next = descend(key, update);
+        if (next && !after(next, key, prefix)) {
+            return {iterator(next), false};
+        }
+        size_t level = random_level();
+        MNode* node = arena.create(level);
+        try {
+            ::new (static_cast<void*>(&node->value)) value_type(std::piecewise_construct,
+                                                                std::forward_as_tuple(std::forward<Key>(key)),
+                                                                std::forward_as_tuple(std::forward<Args>(args)...));
+        } catch (...) {
+            arena.destroy(node);
+            throw;
+        }
+        node->prefix = prefix;
+        for (size_t i = curr_level; i < level; ++i) {
+            update[i] = head;
+        }
+        curr_level = std::max(curr_level, level);
+        for (size_t i = 0; i < level; ++i) {
+            node->forward()[i] = update[i]->forward()[i];
+            update[i]->forward()[i] = node;
+        }
+        entries++;
+        return {iterator(node), true};
+    }
+
+    template <typename Key>
+    size_type erase_key(const Key& key) {
+        MNode* update[MaxLevels];
+        MNode* node = descend(key, update);
+        if (!node || after(node, key, prefix_of(key))) {
+            return 0;
+        }
+        for (size_t i = 0; i < node->level; ++i) {
+            update[i]->forward()[i] = node->forward()[i];
+        }
+        std::destroy_at(&node->value);
+        arena.destroy(node);
+        entries--;
+        while (curr_level > 0 && !head->forward()[curr_level - 1]) {
+            curr_level--;
+        }
+        return 1;
+    }
+};
+
+// Random keys of the given length over a 62-letter alphabet.
+std::vector<std::string> randomKeys(size_t n, size_t length, std::mt19937& g) {
+    static constexpr char Alphabet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    std::vector<std::string> keys(n, std::string(length, ' '));
+    for (auto& k : keys) {
+        for (auto& c : k) {
+            c = Alphabet[g() % 62];
+        }
+    }
+    return keys;
+}
+
+// Inserts every key, looks each one up again through a std::string_view, then scans the map in order.
+// lookup(map, view) returns the mapped value.
+template <typename Map, typename Lookup>
+void stringMapBenchmark(const char* name, const std::vector<std::string>& keys, Lookup lookup) {
+    std::vector<std::string_view> probes(keys.begin(), keys.end());
+    std::mt19937 g(3);
+    std::shuffle(probes.begin(), probes.end(), g);
+    Map map;
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        map[keys[i]] = static_cast<int>(i);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for (auto k : probes) {
+        sum += lookup(map, k);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    for (const auto& [k, v] : map) {
+        sum -= v;
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    assert(sum == 0);
+    auto ns = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / static_cast<double>(keys.size()); };
+    std::cout << "  " << name << " : insert " << ns(t1, t2) << "ns, lookup " << ns(t2, t3) << "ns, scan " << ns(t3, t4) << "ns per key\n";
+}
+
+// Appends v as an unsigned LEB128 varint.
+inline void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+inline bool getVarint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint64_t b = static_cast<unsigned char>(*p++);
+        v |= (b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void putFixed(std::string& out, uint64_t v, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>(v >> (8 * i)));
+    }
+}
+
+inline uint64_t getFixed(const char* p, size_t bytes) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        v |= uint64_t {static_cast<unsigned char>(p[i])} << (8 * i);
+    }
+    return v;
+}
+
+// FNV-1a followed by a 64-bit finalizer, so that every output bit depends on every input bit.
+inline uint64_t hashKey(std::string_view s) noexcept {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : s) {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+inline bool readFile(std::ifstream& in, uint64_t offset, uint64_t size, std::string& out) {
+    out.resize(size);
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(offset));
+    in.read(out.data(), static_cast<std::streamsize>(size));
+    return static_cast<uint64_t>(in.gcount()) == size;
+}
+
+// Bloom filter with double hashing: probe i of a key tests bit h1 + i * h2. About 1% false positives at
+// 10 bits per key. Serialized as the bit count, the probe count, then the bits.
+class BloomFilter {
+public:
+    BloomFilter(size_t keys, size_t bitsPerKey)
+        : bits {std::max<size_t>(64, keys * bitsPerKey)},
+          probes {std::clamp<size_t>(static_cast<size_t>(static_cast<double>(bitsPerKey) * 0.69), 1, 30)},
+          data((bits + 7) / 8) {}
+
+    explicit BloomFilter(std::string_view serialized) {
+        bits = getFixed(serialized.data(), 8);
+        probes = static_cast<unsigned char>(serialized[8]);
+        data.assign(serialized.begin() + 9, serialized.end());
+    }
+
+    void add(std::string_view key) {
+        uint64_t h = hashKey(key);
+        for (size_t i = 0; i < probes; ++i, h += delta(h)) {
+            data[h % bits / 8] |= static_cast<char>(1 << (h % bits % 8));
+        }
+    }
+
+    bool mayContain(std::string_view key) const {
+        uint64_t h = hashKey(key);
+        for (size_t i = 0; i < probes; ++i, h += delta(h)) {
+            if (!(data[h % bits / 8] & (1 << (h % bits % 8)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void serialize(std::string& out) const {
+        putFixed(out, bits, 8);
+        out.push_back(static_cast<char>(probes));
+        out.append(data.begin(), data.end());
+    }
+
+private:
+    size_t bits;
+    size_t probes;
+    std::vector<char> data;
+
+    static uint64_t delta(uint64_t h) noexcept {
+        return (h >> 17) | (h << 47) | 1;
+    }
+};
+
+enum class ValueTag : unsigned char {
+    Value,
+    Tombstone
+};
+
+// Redo log for the memtable. Each record is a 32-bit checksum, the payload length, then the payload:
+// tag, key and value. Every append is flushed to the operating system, so a crashed process loses
+// nothing; replay stops at the first torn or corrupt record, which can only be the tail, and returns
+// the length of the valid prefix so the caller can cut the tail off before appending again.
+class WriteAheadLog {
+public:
+    explicit WriteAheadLog(const std::filesystem::path& path) : out {path, std::ios::binary | std::ios::app} {
+        if (!out) {
+            throw std::runtime_error("WriteAheadLog : cannot open " + path.string());
+        }
+    }
+
+    void append(ValueTag tag, std::string_view key, std::string_view value) {
+        record.clear();
+        record.push_back(static_cast<char>(tag));
+        putVarint(record, key.size());
+        record.append(key);
+        putVarint(record, value.size());
+        record.append(value);
+        header.clear();
+        putFixed(header, hashKey(record) & 0xffffffff, 4);
+        putVarint(header, record.size());
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        out.write(record.data(), static_cast<std::streamsize>(record.size()));
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("WriteAheadLog : write failed");
+        }
+    }
+
+    template <typename Apply>
+    static uint64_t replay(const std::filesystem::path& path, Apply apply) {
+        std::ifstream in {path, std::ios::binary};
+        std::string log {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        const char* p = log.data();
+        const char* end = p + log.size();
+        while (end - p > 4) {
+            uint64_t sum = getFixed(p, 4);
+            const char* q = p + 4;
+            uint64_t size, keySize, valueSize;
+            if (!getVarint(q, end, size) || size == 0 || static_cast<uint64_t>(end - q) < size ||
+                (hashKey(std::string_view(q, size)) & 0xffffffff) != sum) {
+                break;
+            }
+            const char* r = q + 1;
+            const char* recordEnd = q + size;
+            if (!getVarint(r, recordEnd, keySize) || static_cast<uint64_t>(recordEnd - r) < keySize) {
+                break;
+            }
+            std::string_view key(r, keySize);
+            r += keySize;
+            if (!getVarint(r, recordEnd, valueSize) || static_cast<uint64_t>(recordEnd - r) != valueSize) {
+                break;
+            }
+            apply(static_cast<ValueTag>(*q), key, std::string_view(r, valueSize));
+            p = recordEnd;
+        }
+        return static_cast<uint64_t>(p - log.data());
+    }
+
+private:
+    std::ofstream out;
+    std::string record;
+    std::string header;
+};
+
+// Writes an immutable sorted run: data blocks, a bloom filter over every key, a sparse index with the
+// last key, offset and size of each block, and a fixed footer locating the filter and the index.
+// Keys within a block are prefix-compressed against the previous key: a record is the shared length,
+// the unshared suffix, the tag and the value. Keys must be added in strictly increasing order.
+class SortedRunWriter {
+public:
+    SortedRunWriter(const std::filesystem::path& path, size_t expectedKeys, size_t blockBytes, size_t bloomBitsPerKey)
+        : out {path, std::ios::binary | std::ios::trunc}, blockBytes {blockBytes}, bloom {expectedKeys, bloomBitsPerKey} {
+        if (!out) {
+            throw std::runtime_error("SortedRunWriter : cannot open " + path.string());
+        }
+    }
+
+    void add(std::string_view key, ValueTag tag, std::string_view value) {
+        assert(entries == 0 || lastKey < key);
+        size_t shared = 0;
+        if (!block.empty()) {
+            size_t limit = std::min(lastKey.size(), key.size());
+            while (shared < limit && lastKey[shared] == key[shared]) {
+                shared++;
+            }
+        }
+        putVarint(block, shared);
+        putVarint(block, key.size() - shared);
+        block.append(key.substr(shared));
+        block.push_back(static_cast<char>(tag));
+        putVarint(block, value.size());
+        block.append(value);
+        lastKey.assign(key);
+        bloom.add(key);
+        entries++;
+        rawBytes += key.size() + value.size();
+        if (block.size() >= blockBytes) {
+            finishBlock();
+        }
+    }
+
+    // Returns the size of the finished file.
+    uint64_t finish() {
+        finishBlock();
+        std::string tail;
+        uint64_t bloomOffset = offset;
+        bloom.serialize(tail);
+        uint64_t indexOffset = offset + tail.size();
+        tail.append(index);
+        putFixed(tail, bloomOffset, 8);
+        putFixed(tail, indexOffset, 8);
+        putFixed(tail, entries, 8);
+        putFixed(tail, Magic, 8);
+        out.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("SortedRunWriter : write failed");
+        }
+        return offset + tail.size();
+    }
+
+    uint64_t keyValueBytes() const noexcept {
+        return rawBytes;
+    }
+
+    static constexpr uint64_t Magic = 0x4e55524445545253ull;
+    static constexpr size_t FooterBytes = 32;
+
+private:
+    std::ofstream out;
+    size_t blockBytes;
+    BloomFilter bloom;
+    std::string block;
+    std::string index;
+    std::string lastKey;
+    uint64_t offset = 0;
+    uint64_t entries = 0;
+    uint64_t rawBytes = 0;
+
+    void finishBlock() {
+        if (block.empty()) {
+            return;
+        }
+        out.write(block.data(), static_cast<std::streamsize>(block.size()));
+        putVarint(index, lastKey.size());
+        index.append(lastKey);
+        putVarint(index, offset);
+        putVarint(index, block.size());
+        offset += block.size();
+        block.clear();
+    }
+};
+
+// Decodes the records of one data block in order. Positions are kept as offsets into data, so a
+// reader stays valid when moved, including when a short block lives in the string's inline buffer.
+class BlockReader {
+public:
+    BlockReader() = default;
+
+    explicit BlockReader(std::string data) : data {std::move(data)} {
+        next();
+    }
+
+    bool valid() const noexcept {
+        return ok;
+    }
+
+    const std::string& key() const noexcept {
+        return current;
+    }
+
+    ValueTag tag() const noexcept {
+        return currentTag;
+    }
+
+    std::string_view value() const noexcept {
+        return std::string_view(data).substr(valueOffset, valueSize);
+    }
+
+    void next() {
+        const char* p = data.data() + offset;
+        const char* end = data.data() + data.size();
+        uint64_t shared, unshared;
+        ok = p < end && getVarint(p, end, shared) && getVarint(p, end, unshared) &&
+             shared <= current.size() && unshared + 1 <= static_cast<uint64_t>(end - p);
+        if (!ok) {
+            return;
+        }
+        current.resize(shared);
+        current.append(p, unshared);
+        p += unshared;
+        currentTag = static_cast<ValueTag>(*p++);
+        ok = getVarint(p, end, valueSize) && valueSize <= static_cast<uint64_t>(end - p);
+        if (ok) {
+            valueOffset = static_cast<size_t>(p - data.data());
+            offset = valueOffset + valueSize;
+        }
+    }
+
+private:
+    std::string data;
+    size_t offset = 0;
+    std::string current;
+    ValueTag currentTag = ValueTag::Value;
+    size_t valueOffset = 0;
+    uint64_t valueSize = 0;
+    bool ok = false;
+};
+
+// Read side of a sorted run. The bloom filter and the sparse index stay in memory, so a lookup
+// reads at most one block, and none when the filter rules the key out.
+// A run marked obsolete by compaction deletes its file when the last reader lets go of it.
+class SortedRun {
+public:
+    enum class Lookup {
+        Absent,
+        Found,
+        Deleted
+    };
+
+    struct IndexEntry {
+        std::string lastKey;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    SortedRun(std::filesystem::path path, uint64_t number) : path {std::move(path)}, number {number}, in {this->path, std::ios::binary} {
+        uint64_t fileSize = std::filesystem::file_size(this->path);
+        std::string footer;
+        if (fileSize < SortedRunWriter::FooterBytes || !readFile(in, fileSize - SortedRunWriter::FooterBytes, SortedRunWriter::FooterBytes, footer) ||
+            getFixed(footer.data() + 24, 8) != SortedRunWriter::Magic) {
+            throw std::runtime_error("SortedRun : bad footer in " + this->path.string());
+        }
+        uint64_t bloomOffset = getFixed(footer.data(), 8);
+        uint64_t indexOffset = getFixed(footer.data() + 8, 8);
+        entries = getFixed(footer.data() + 16, 8);
+        uint64_t metaEnd = fileSize - SortedRunWriter::FooterBytes;
+        std::string meta;
+        if (bloomOffset > indexOffset || indexOffset > metaEnd || indexOffset - bloomOffset < 9 ||
+            !readFile(in, bloomOffset, metaEnd - bloomOffset, meta)) {
+            throw std::runtime_error("SortedRun : bad filter in " + this->path.string());
+        }
+        bloom.emplace(std::string_view(meta).substr(0, indexOffset - bloomOffset));
+        const char* p = meta.data() + (indexOffset - bloomOffset);
+        const char* end = meta.data() + meta.size();
+        while (p < end) {
+            uint64_t keySize;
+            IndexEntry e;
+            if (!getVarint(p, end, keySize) || static_cast<uint64_t>(end - p) < keySize) {
+                throw std::runtime_error("SortedRun : bad index in " + this->path.string());
+            }
+            e.lastKey.assign(p, keySize);
+            p += keySize;
+            if (!getVarint(p, end, e.offset) || !getVarint(p, end, e.size) || e.offset > bloomOffset ||
+                e.size > bloomOffset - e.offset) {
+                throw std::runtime_error("SortedRun : bad index in " + this->path.string());
+            }
+            index.push_back(std::move(e));
+        }
+        bytes = fileSize;
+    }
+
+    SortedRun(const SortedRun&) = delete;
+    SortedRun& operator=(const SortedRun&) = delete;
+
+    ~SortedRun() {
+        if (obsolete) {
+            in.close();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    }
+
+    Lookup get(std::string_view key, std::string& value) const {
+        if (!bloom->mayContain(key)) {
+            return Lookup::Absent;
+        }
+        auto block = std::lower_bound(index.begin(), index.end(), key, [](const IndexEntry& e, std::string_view k) {
+            return e.lastKey < k;
+        });
+        if (block == index.end()) {
+            return Lookup::Absent;
+        }
+        for (BlockReader r(readBlock(*block)); r.valid() && r.key() <= key; r.next()) {
+            if (r.key() == key) {
+                if (r.tag() == ValueTag::Tombstone) {
+                    return Lookup::Deleted;
+                }
+                value.assign(r.value());
+                return Lookup::Found;
+            }
+        }
+        return Lookup::Absent;
+    }
+
+    std::string readBlock(const IndexEntry& e) const {
+        std::lock_guard<std::mutex> lock(m);
+        std::string data;
+        if (!readFile(in, e.offset, e.size, data)) {
+            throw std::runtime_error("SortedRun : short read from " + path.string());
+        }
+        return data;
+    }
+
+    // Walks every record of the run in key order, one block at a time.
+    class Cursor {
+    public:
+        explicit Cursor(const SortedRun& run) : run {&run} {
+            advanceBlock();
+        }
+
+        bool valid() const noexcept {
+            return reader.valid();
+        }
+
+        const BlockReader& operator*() const noexcept {
+            return reader;
+        }
+
+        void next() {
+            reader.next();
+            if (!reader.valid()) {
+                advanceBlock();
+            }
+        }
+
+    private:
+        const SortedRun* run;
+        size_t block = 0;
+        BlockReader reader;
+
+        void advanceBlock() {
+            while (!reader.valid() && block < run->index.size()) {
+                reader = BlockReader(run->readBlock(run->index[block++]));
+            }
+        }
+    };
+
+    void markObsolete() noexcept {
+        obsolete = true;
+    }
+
+    const std::filesystem::path path;
+    const uint64_t number;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+
+private:
+    mutable std::mutex m;
+    mutable std::ifstream in;
+    std::optional<BloomFilter> bloom;
+    std::vector<IndexEntry> index;
+    std::atomic<bool> obsolete {false};
+};
+
+struct LsmOptions {
+    size_t memtableBytes = 4 << 20;
+    size_t blockBytes = 4096;
+    size_t bloomBitsPerKey = 10;
+    // Compaction starts once there are this many runs.
+    size_t compactionTrigger = 4;
+};
+
+// Small embedded key-value store. A write is appended to the write-ahead log and then applied to the
+// memtable, a SkipListMap in which a missing value is a tombstone. A full memtable is written out as a
+// new sorted run, newest first in the MANIFEST, and the log starts over. A background thread merges all
+// runs into one whenever compactionTrigger of them have piled up; because the merge covers the oldest
+// data, it can drop tombstones. Reads check the memtable, then the runs from newest to oldest.
+// Writes and reads come from one thread; only the run list is shared with the compactor.
+// The MANIFEST is replaced by rename, so a crash leaves either the old or the new set of runs,
+// and files not named in it are leftovers that recovery deletes.
+class LsmStore {
+public:
+    explicit LsmStore(std::filesystem::path dir, LsmOptions options = {}) : dir {std::move(dir)}, options {options} {
+        std::filesystem::create_directories(this->dir);
+        std::ifstream manifest {this->dir / "MANIFEST"};
+        std::set<std::string> live {"MANIFEST", "wal.log"};
+        for (uint64_t number; manifest >> number;) {
+            runs.push_back(std::make_shared<SortedRun>(runPath(number), number));
+            live.insert(runPath(number).filename().string());
+            nextNumber = std::max(nextNumber, number + 1);
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(this->dir)) {
+            if (!live.contains(entry.path().filename().string())) {
+                std::filesystem::remove(entry.path());
+            }
+        }
+        std::filesystem::path log = this->dir / "wal.log";
+        uint64_t valid = WriteAheadLog::replay(log, [this](ValueTag tag, std::string_view key, std::string_view value) {
+            apply(tag, key, value);
+        });
+        // Appending behind a torn tail would hide every later record from the next replay.
+        if (std::filesystem::exists(log) && std::filesystem::file_size(log) > valid) {
+            std::filesystem::resize_file(log, valid);
+        }
+        wal.emplace(log);
+        compactor = std::thread([this] { compactLoop(); });
+    }
+
+    LsmStore(const LsmStore&) = delete;
+    LsmStore& operator=(const LsmStore&) = delete;
+
+    // The memtable is not flushed; the log already holds it.
+    ~LsmStore() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        compactor.join();
+    }
+
+    void put(std::string_view key, std::string_view value) {
+        write(ValueTag::Value, key, value);
+    }
+
+    void erase(std::string_view key) {
+        write(ValueTag::Tombstone, key, {});
+    }
+
+    std::optional<std::string> get(std::string_view key) const {
+        if (auto it = memtable.find(key); it != memtable.end()) {
+            return it->second;
+        }
+        std::string value;
+        for (const auto& run : snapshot()) {
+            switch (run->get(key, value)) {
+                case SortedRun::Lookup::Found: return value;
+                case SortedRun::Lookup::Deleted: return std::nullopt;
+                case SortedRun::Lookup::Absent: break;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Blocks until the compactor has nothing left to do, and rethrows the error that stopped it, if any.
+    void waitForCompaction() {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this] { return compactionError || (!compacting && runs.size() < options.compactionTrigger); });
+        if (compactionError) {
+            std::rethrow_exception(compactionError);
+        }
+    }
+
+    size_t runCount() const {
+        std::lock_guard<std::mutex> lock(m);
+        return runs.size();
+    }
+
+    uint64_t diskBytes() const {
+        uint64_t total = 0;
+        for (const auto& run : snapshot()) {
+            total += run->bytes;
+        }
+        return total;
+    }
+
+    size_t compactions() const {
+        std::lock_guard<std::mutex> lock(m);
+        return compactionCount;
+    }
+
+private:
+    std::filesystem::path dir;
+    LsmOptions options;
+    SkipListMap<std::string, std::optional<std::string>, std::less<>> memtable;
+    size_t memtableBytes = 0;
+    std::optional<WriteAheadLog> wal;
+
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<SortedRun>> runs;
+    uint64_t nextNumber = 1;
+    size_t compactionCount = 0;
+    bool compacting = false;
+    bool stopping = false;
+    std::exception_ptr compactionError;
+    std::thread compactor;
+
+    std::filesystem::path runPath(uint64_t number) const {
+        return dir / ("run-" + std::to_string(number) + ".sst");
+    }
+
+    std::vector<std::shared_ptr<SortedRun>> snapshot() const {
+        std::lock_guard<std::mutex> lock(m);
+        return runs;
+    }
+
+    void apply(ValueTag tag, std::string_view key, std::string_view value) {
+        auto [it, inserted] = memtable.try_emplace(std::string(key));
+        if (inserted) {
+            memtableBytes += key.size() + sizeof(it->second) + 48;
+        } else if (it->second) {
+            memtableBytes -= it->second->size();
+        }
+        if (tag == ValueTag::Value) {
+            it->second.emplace(value);
+            memtableBytes += value.size();
+        } else {
+            it->second.reset();
+        }
+    }
+
+    void write(ValueTag tag, std::string_view key, std::string_view value) {
+        wal->append(tag, key, value);
+        apply(tag, key, value);
+        if (memtableBytes >= options.memtableBytes) {
+            flush();
+        }
+    }
+
+    // Must be called with m held.
+    void writeManifest() {
+        std::filesystem::path tmp = dir / "MANIFEST.tmp";
+        {
+            std::ofstream out {tmp, std::ios::trunc};
+            for (const auto& run : runs) {
+                out << run->number << "\n";
+            }
+            out.flush();
+            if (!out) {
+                throw std::runtime_error("LsmStore : cannot write MANIFEST");
+            }
+        }
+        std::filesystem::rename(tmp, dir / "MANIFEST");
+    }
+
+    void flush() {
+        uint64_t number;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            number = nextNumber++;
+        }
+        SortedRunWriter writer(runPath(number), memtable.size(), options.blockBytes, options.bloomBitsPerKey);
+        for (const auto& [key, value] : memtable) {
+            writer.add(key, value ? ValueTag::Value : ValueTag::Tombstone, value ? std::string_view(*value) : std::string_view());
+        }
+        writer.finish();
+        auto run = std::make_shared<SortedRun>(runPath(number), number);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            runs.insert(runs.begin(), std::move(run));
+            writeManifest();
+        }
+        cv.notify_all();
+        wal.reset();
+        std::filesystem::remove(dir / "wal.log");
+        wal.emplace(dir / "wal.log");
+        memtable.clear();
+        memtableBytes = 0;
+    }
+
+    void compactLoop() {
+        std::unique_lock<std::mutex> lock(m);
+        while (true) {
+            cv.wait(lock, [this] { return stopping || runs.size() >= options.compactionTrigger; });
+            if (stopping) {
+                return;
+            }
+            compacting = true;
+            std::vector<std::shared_ptr<SortedRun>> inputs = runs;
+            uint64_t number = nextNumber++;
+            lock.unlock();
+            // A failed merge or MANIFEST write keeps the old runs and stops compaction;
+            // waitForCompaction() reports the error instead of the thread terminating the process.
+            try {
+                auto merged = merge(inputs, number);
+                lock.lock();
+                std::vector<std::shared_ptr<SortedRun>> previous = runs;
+                runs.erase(runs.end() - static_cast<std::ptrdiff_t>(inputs.size()), runs.end());
+                if (merged) {
+                    runs.push_back(std::move(merged));
+                }
+                try {
+                    writeManifest();
+                } catch (...) {
+                    runs = std::move(previous);
+                    throw;
+                }
+            } catch (...) {
+                if (!lock.owns_lock()) {
+                    lock.lock();
+                }
+                std::error_code ec;
+                std::filesystem::remove(runPath(number), ec);
+                compactionError = std::current_exception();
+                compacting = false;
+                cv.notify_all();
+                return;
+            }
+            for (auto& run : inputs) {
+                run->markObsolete();
+            }
+            compacting = false;
+            compactionCount++;
+            cv.notify_all();
+        }
+    }
+
+    // Merges runs, newest first, into one run; the newest record of each key wins and tombstones are dropped.
+    std::shared_ptr<SortedRun> merge(const std::vector<std::shared_ptr<SortedRun>>& inputs, uint64_t number) {
+        std::vector<SortedRun::Cursor> cursors;
+        uint64_t entries = 0;
+        for (const auto& run : inputs) {
+            cursors.emplace_back(*run);
+            entries += run->entries;
+        }
+        SortedRunWriter writer(runPath(number), entries, options.blockBytes, options.bloomBitsPerKey);
+        bool any = false;
+        while (true) {
+            const std::string* smallest = nullptr;
+            size_t winner = 0;
+            for (size_t i = 0; i < cursors.size(); ++i) {
+                if (cursors[i].valid() && (!smallest || (*cursors[i]).key() < *smallest)) {
+                    smallest = &(*cursors[i]).key();
+                    winner = i;
+                }
+            }
+            if (!smallest) {
+                break;
+            }
+            std::string key = *smallest;
+            if ((*cursors[winner]).tag() == ValueTag::Value) {
+                writer.add(key, ValueTag::Value, (*cursors[winner]).value());
+                any = true;
+            }
+            for (auto& c : cursors) {
+                if (c.valid() && (*c).key() == key) {
+                    c.next();
+                }
+            }
+        }
+        writer.finish();
+        if (!any) {
+            std::filesystem::remove(runPath(number));
+            return nullptr;
+        }
+        return std::make_shared<SortedRun>(runPath(number), number);
+    }
+};
+
+// Workload generator for LsmStore: fixed-width keys drawn uniformly from a key space, values of a fixed
+// size. Checks every result against a std::map model, including after the store is closed and reopened.
+void lsmWorkload(const std::filesystem::path& dir, size_t keySpace, size_t operations, size_t valueBytes) {
+    std::filesystem::remove_all(dir);
+    std::mt19937_64 g(17);
+    std::map<std::string, std::string> model;
+    auto keyOf = [](uint64_t i) {
+        std::string k = std::to_string(i);
+        return "key" + std::string(12 - k.size(), '0') + k;
+    };
+    auto valueOf = [&](uint64_t seed) {
+        std::string v(valueBytes, ' ');
+        for (size_t i = 0; i < valueBytes; ++i) {
+            v[i] = static_cast<char>('a' + (seed + i * 7) % 26);
+        }
+        return v;
+    };
+    LsmOptions options;
+    options.memtableBytes = 1 << 20;
+    {
+        LsmStore store(dir, options);
+        auto t1 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < operations; ++i) {
+            std::string key = keyOf(g() % keySpace);
+            if (g() % 10 == 0) {
+                store.erase(key);
+                model.erase(key);
+            } else {
+                std::string value = valueOf(g());
+                store.put(key, value);
+                model[key] = std::move(value);
+            }
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        size_t hits = 0;
+        for (size_t i = 0; i < operations; ++i) {
+            std::string key = keyOf(g() % (2 * keySpace));
+            auto value = store.get(key);
+            auto expected = model.find(key);
+            assert(expected == model.end() ? !value : value && *value == expected->second);
+            hits += value.has_value();
+        }
+        auto t3 = std::chrono::steady_clock::now();
+        store.waitForCompaction();
+        uint64_t raw = 0;
+        for (const auto& [k, v] : model) {
+            raw += k.size() + v.size();
+        }
+        auto rate = [&](auto a, auto b) { return static_cast<double>(operations) / std::chrono::duration<double>(b - a).count() / 1e3; };
+        std::cout << "LsmStore : " << rate(t1, t2) << "k writes/s, " << rate(t2, t3) << "k reads/s (" << hits << " hits), "
+                  << store.compactions() << " compactions, " << store.runCount() << " runs, "
+                  << store.diskBytes() / 1024 << " KB on disk for " << raw / 1024 << " KB of live keys and values\n";
+    }
+    {
+        // A record torn by a crash mid-append.
+        std::ofstream wal {dir / "wal.log", std::ios::binary | std::ios::app};
+        wal << "\x12\x34\x56\x78\x40partial";
+    }
+    {
+        // Writes after recovering from the torn tail must survive the next recovery.
+        LsmStore store(dir, options);
+        for (size_t i = 0; i < 1'000; ++i) {
+            std::string key = keyOf(g() % keySpace);
+            if (i % 10 == 0) {
+                store.erase(key);
+                model.erase(key);
+            } else {
+                std::string value = valueOf(g());
+                store.put(key, value);
+                model[key] = std::move(value);
+            }
+        }
+    }
+    {
+        LsmStore store(dir, options);
+        for (const auto& [k, v] : model) {
+            auto value = store.get(k);
+            assert(value && *value == v);
+        }
+        for (size_t i = 0; i < keySpace; i += 97) {
+            assert(store.get(keyOf(i)).has_value() == model.contains(keyOf(i)));
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// Flushes after every write and compacts every two runs, so merged blocks are only a few bytes long.
+void lsmTinyCompaction(const std::filesystem::path& dir) {
+    std::filesystem::remove_all(dir);
+    LsmOptions options;
+    options.memtableBytes = 1;
+    options.compactionTrigger = 2;
+    std::map<std::string, std::string> model;
+    {
+        LsmStore store(dir, options);
+        for (int i = 0; i < 40; ++i) {
+            std::string key(1, static_cast<char>('a' + i % 26));
+            std::string value = std::to_string(i);
+            if (i % 7 == 6) {
+                store.erase(key);
+                model.erase(key);
+            } else {
+                store.put(key, value);
+                model[key] = value;
+            }
+            store.waitForCompaction();
+        }
+        assert(store.compactions() > 0);
+        for (char c = 'a'; c <= 'z'; ++c) {
+            std::string key(1, c);
+            auto value = store.get(key);
+            auto expected = model.find(key);
+            assert(expected == model.end() ? !value : value && *value == expected->second);
+        }
+    }
+    {
+        LsmStore store(dir, options);
+        for (const auto& [k, v] : model) {
+            assert(store.get(k) == v);
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// Node of a ConcurrentSkipList. Same inline-tower layout as Node, but every link is atomic and its low bit
+// marks the link as deleted: a node whose level-0 link is marked is logically gone from the set.
+// owners counts the inserter and the list; the node is retired when both have let go, which is
+// only after each has run a find() that unlinked it from every level it managed to reach.
+template <typename T>
+struct ConcurrentNode {
+    static constexpr uintptr_t Mark = 1;
+    static constexpr size_t Align = std::max(alignof(T), alignof(std::atomic<uintptr_t>));
+
+    T key;
+    size_t level;
+    std::atomic<unsigned> owners;
+
+    ConcurrentNode(T key, size_t level) : key {std::move(key)}, level {level}, owners {2} {
+        for (size_t i = 0; i < level; ++i) {
+            ::new (static_cast<void*>(links() + i)) std::atomic<uintptr_t>(0);
+        }
+    }
+
+    std::atomic<uintptr_t>* forward() noexcept {
+        return std::launder(links());
+    }
+
+    static ConcurrentNode* create(const T& key, size_t level) {
+        void* p = ::operator new(linksOffset() + level * sizeof(std::atomic<uintptr_t>), std::align_val_t {Align});
+        try {
+            return ::new (p) ConcurrentNode(key, level);
+        } catch (...) {
+            ::operator delete(p, std::align_val_t {Align});
+            throw;
+        }
+    }
+
+    static void destroy(ConcurrentNode* node) noexcept {
+        node->~ConcurrentNode();
+        ::operator delete(static_cast<void*>(node), std::align_val_t {Align});
+    }
+
+    static ConcurrentNode* ptr(uintptr_t link) noexcept {
+        return reinterpret_cast<ConcurrentNode*>(link & ~Mark);
+    }
+
+    static bool marked(uintptr_t link) noexcept {
+        return link & Mark;
+    }
+
+    static uintptr_t link(ConcurrentNode* node) noexcept {
+        return reinterpret_cast<uintptr_t>(node);
+    }
+
+private:
+    std::atomic<uintptr_t>* links() noexcept {
+        return reinterpret_cast<std::atomic<uintptr_t>*>(reinterpret_cast<std::byte*>(this) + linksOffset());
+    }
+
+    static constexpr size_t linksOffset() noexcept {
+        return (sizeof(ConcurrentNode) + alignof(std::atomic<uintptr_t>) - 1) & ~(alignof(std::atomic<uintptr_t>) - 1);
+    }
+};
+
+template <typename T>
+struct ConcurrentNodeDelete {
+    void operator()(ConcurrentNode<T>* node) const noexcept {
+        ConcurrentNode<T>::destroy(node);
+    }
+};
+
+// Lock-free skip list set after Herlihy, Lev and Shavit. contains() never writes shared memory;
+// insert() links the bottom level with one CAS, which is its linearization point, then links the
+// upper levels one CAS at a time; erase() marks the tower top-down, and the thread whose CAS marks
+// level 0 wins. Marked nodes are unlinked by whichever find() passes them, and freed through
+// EpochDomain, so a reader may keep walking a node that has just been removed.
+template <typename T>
+class ConcurrentSkipList {
+    using CNode = ConcurrentNode<T>;
+
+public:
+    static constexpr size_t MaxLevels = 32;
+
+    ConcurrentSkipList(size_t levels, float prob) : levels {levels}, prob {prob},
+                                                    promote {static_cast<uint32_t>(std::min(std::ldexp(double {prob}, 32), 4294967295.0))} {
+        assert(levels > 0 && levels <= MaxLevels);
+        head = CNode::create(T {}, levels);
+    }
+
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+    // Must not race with any other operation. Nodes already retired are left to EpochDomain.
+    ~ConcurrentSkipList() {
+        CNode* curr = head;
+        while (curr) {
+            CNode* next = CNode::ptr(curr->forward()[0].load(std::memory_order_relaxed));
+            CNode::destroy(curr);
+            curr = next;
+        }
+    }
+
+    bool contains(const T& key) const {
+        EpochDomain::Guard guard;
+        CNode* pred = head;
+        CNode* curr = nullptr;
+        for (size_t i = height.load(std::memory_order_relaxed); i-- > 0;) {
+            curr = CNode::ptr(pred->forward()[i].load(std::memory_order_acquire));
+            while (curr) {
+                uintptr_t succ = curr->forward()[i].load(std::memory_order_acquire);
+                while (CNode::marked(succ)) {
+                    curr = CNode::ptr(succ);
+                    if (!curr) {
+                        break;
+                    }
+                    succ = curr->forward()[i].load(std::memory_order_acquire);
+                }
+                if (curr && curr->key < key) {
+                    pred = curr;
+                    curr = CNode::ptr(succ);
+                } else {
+                    break;
+                }
+            }
+        }
+        return curr && curr->key == key;
+    }
+
+    bool insert(const T& key) {
+        EpochDomain::Guard guard;
+        CNode* preds[MaxLevels];
+        CNode* succs[MaxLevels];
+        size_t top = random_level();
+        raise_height(top);
+        CNode* node = nullptr;
+        while (true) {
+            if (find(key, preds, succs, top)) {
+                if (node) {
+                    CNode::destroy(node);
+                }
+                return false;
+            }
+            if (!node) {
+                node = CNode::create(key, top);
+            }
+            for (size_t i = 0; i < top; ++i) {
+                node->forward()[i].store(CNode::link(succs[i]), std::memory_order_relaxed);
+            }
+            uintptr_t expected = CNode::link(succs[0]);
+            if (preds[0]->forward()[0].compare_exchange_strong(expected, CNode::link(node), std::memory_order_seq_cst)) {
+                break;
+            }
+        }
+        // The node is in the set now. An erase() may mark it at any moment, and then linking stops.
+        for (size_t i = 1; i < top && link_level(node, i, preds, succs); ++i) {}
+        if (CNode::marked(node->forward()[0].load(std::memory_order_seq_cst))) {
+            find(key, preds, succs, top);
+        }
+        release(node);
+        return true;
+    }
+
+    bool erase(const T& key) {
+        EpochDomain::Guard guard;
+        CNode* preds[MaxLevels];
+        CNode* succs[MaxLevels];
+        if (!find(key, preds, succs)) {
+            return false;
+        }
+        CNode* victim = succs[0];
+        for (size_t i = victim->level; i-- > 1;) {
+            uintptr_t next = victim->forward()[i].load(std::memory_order_relaxed);
+            while (!CNode::marked(next) && !victim->forward()[i].compare_exchange_weak(next, next | CNode::Mark, std::memory_order_seq_cst)) {}
+        }
+        uintptr_t next = victim->forward()[0].load(std::memory_order_relaxed);
+        while (!CNode::marked(next)) {
+            if (victim->forward()[0].compare_exchange_weak(next, next | CNode::Mark, std::memory_order_seq_cst)) {
+                find(key, preds, succs, victim->level);
+                release(victim);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    size_t levels;
+    float prob;
+    // A level is added while a draw falls below this, i.e. with probability prob.
+    uint32_t promote;
+    CNode* head;
+    // One more than the highest level any node has been given; searches start there rather than at levels.
+    // It only grows, and a stale value just skips express lanes, which is always safe for a search.
+    std::atomic<size_t> height {1};
+
+    size_t random_level() const {
+        static thread_local std::mt19937 g(std::random_device{}());
+        size_t level = 1;
+        while (g() < promote && level < levels) {
+            level++;
+        }
+        return level;
+    }
+
+    void raise_height(size_t top) {
+        size_t h = height.load(std::memory_order_relaxed);
+        while (h < top && !height.compare_exchange_weak(h, top, std::memory_order_relaxed)) {}
+    }
+
+    // Fills preds and succs around key on every level below max(top, height), unlinking marked nodes
+    // on the way, and reports whether an unmarked node with key is at the bottom. Callers that link or
+    // unlink a node pass its level as top, so its whole tower is covered even if height is stale.
+    bool find(const T& key, CNode** preds, CNode** succs, size_t top = 1) {
+        while (!try_find(key, preds, succs, top)) {}
+        return succs[0] && succs[0]->key == key;
+    }
+
+    // Gives up as soon as a CAS that unlinks a marked node fails, since pred may itself have been removed.
+    bool try_find(const T& key, CNode** preds, CNode** succs, size_t top) {
+        CNode* pred = head;
+        for (size_t i = std::max(top, height.load(std::memory_order_relaxed)); i-- > 0;) {
+            CNode* curr = CNode::ptr(pred->forward()[i].load(std::memory_order_acquire));
+            while (curr) {
+                uintptr_t succ = curr->forward()[i].load(std::memory_order_acquire);
+                while (CNode::marked(succ)) {
+                    uintptr_t expected = CNode::link(curr);
+                    if (!pred->forward()[i].compare_exchange_strong(expected, succ & ~CNode::Mark, std::memory_order_seq_cst)) {
+                        return false;
+                    }
+                    curr = CNode::ptr(succ);
+                    if (!curr) {
+                        break;
+                    }
+                    succ = curr->forward()[i].load(std::memory_order_acquire);
+                }
+                if (curr && curr->key < key) {
+                    pred = curr;
+                    curr = CNode::ptr(succ);
+                } else {
+                    break;
+                }
+            }
+            preds[i] = pred;
+            succs[i] = curr;
+        }
+        return true;
+    }
+
+    // Links node into level i, retrying with fresh neighbours. Returns false once the node has been marked.
+    bool link_level(CNode* node, size_t i, CNode** preds, CNode** succs) {
+        while (true) {
+            uintptr_t next = node->forward()[i].load(std::memory_order_seq_cst);
+            if (CNode::marked(next)) {
+                return false;
+            }
+            if (next != CNode::link(succs[i]) &&
+                !node->forward()[i].compare_exchange_strong(next, CNode::link(succs[i]), std::memory_order_seq_cst)) {
+                return false;
+            }
+            uintptr_t expected = CNode::link(succs[i]);
+            if (preds[i]->forward()[i].compare_exchange_strong(expected, CNode::link(node), std::memory_order_seq_cst)) {
+                return true;
+            }
+            find(node->key, preds, succs, node->level);
+        }
+    }
+
+    void release(CNode* node) {
+        if (node->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            EpochDomain::retire(node, ConcurrentNodeDelete<T> {});
+        }
+    }
+};
+
+// One operation of the linearizability test, stamped from a shared counter when it was called and when it returned.
+struct HistoryOp {
+    enum Kind { Insert, Erase, Contains } kind;
+    int key;
+    bool result;
+    uint64_t call;
+    uint64_t ret;
+};
+
+// Linearizability is local, so a set is linearizable exactly when the history of each key is, viewed as
+// a history of a single boolean. Searches the orders that respect real time for one that explains every
+// result and ends in finalState, memoizing visited (done, state) pairs. Takes at most 64 operations.
+bool linearizable(const std::vector<HistoryOp>& ops, bool state, bool finalState) {
+    assert(ops.size() <= 64);
+    uint64_t all = ops.size() == 64 ? ~uint64_t {0} : (uint64_t {1} << ops.size()) - 1;
+    std::set<std::pair<uint64_t, bool>> seen;
+    auto search = [&](auto& self, uint64_t done, bool present) -> bool {
+        if (done == all) {
+            return present == finalState;
+        }
+        if (!seen.insert({done, present}).second) {
+            return false;
+        }
+        uint64_t firstReturn = std::numeric_limits<uint64_t>::max();
+        for (size_t j = 0; j < ops.size(); ++j) {
+            if (!(done >> j & 1)) {
+                firstReturn = std::min(firstReturn, ops[j].ret);
+            }
+        }
+        for (size_t j = 0; j < ops.size(); ++j) {
+            if (done >> j & 1 || ops[j].call > firstReturn) {
+                continue;
+            }
+            const HistoryOp& op = ops[j];
+            bool expected = op.kind == HistoryOp::Insert ? !present : present;
+            bool next = op.kind == HistoryOp::Insert ? true : op.kind == HistoryOp::Erase ? false : present;
+            if (op.result == expected && self(self, done | uint64_t {1} << j, next)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    return search(search, 0, state);
+}
+
+// Threads run short bursts of random operations on a few keys; at the barrier between bursts,
+// the completion step checks every key's history and carries its state into the next burst.
+void linearizabilityStress(ConcurrentSkipList<int>& list, size_t threads, size_t rounds) {
+    constexpr int Keys = 8;
+    constexpr size_t OpsPerRound = 16;
+    assert(threads * OpsPerRound <= 64);
+    std::atomic<uint64_t> clock {0};
+    std::vector<std::vector<HistoryOp>> histories(threads);
+    std::vector<bool> present(Keys);
+    for (int k = 0; k < Keys; ++k) {
+        present[k] = list.contains(k);
+    }
+    auto check = [&]() noexcept {
+        for (int k = 0; k < Keys; ++k) {
+            std::vector<HistoryOp> ops;
+            for (auto& h : histories) {
+                std::copy_if(h.begin(), h.end(), std::back_inserter(ops), [k](const HistoryOp& op) { return op.key == k; });
+            }
+            bool now = list.contains(k);
+            bool ok = linearizable(ops, present[k], now);
+            assert(ok);
+            present[k] = now;
+        }
+        for (auto& h : histories) {
+            h.clear();
+        }
+    };
+    std::barrier sync(static_cast<std::ptrdiff_t>(threads), check);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 g(static_cast<unsigned>(t + 1));
+            for (size_t r = 0; r < rounds; ++r) {
+                for (size_t i = 0; i < OpsPerRound; ++i) {
+                    HistoryOp op {static_cast<HistoryOp::Kind>(g() % 3), static_cast<int>(g() % Keys), false, 0, 0};
+                    op.call = clock.fetch_add(1);
+                    switch (op.kind) {
+                        case HistoryOp::Insert: op.result = list.insert(op.key); break;
+                        case HistoryOp::Erase: op.result = list.erase(op.key); break;
+                        case HistoryOp::Contains: op.result = list.contains(op.key); break;
+                    }
+                    op.ret = clock.fetch_add(1);
+                    histories[t].push_back(op);
+                }
+                sync.arrive_and_wait();
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+// Mean latency of a search hit and of an insert undone by an erase, on a list that stays at n keys.
+// Small lists sit in L1, so what is left there is the fixed cost of each operation.
+void operationLatency(size_t n) {
+    constexpr size_t Ops = 1'000'000;
+    SkipList<int> list(20, 0.5);
+    for (size_t i = 0; i < n; ++i) {
+        list.insert(static_cast<int>(2 * i));
+    }
+    std::mt19937 g(7);
+    std::vector<int> hits(Ops);
+    std::vector<int> misses(Ops);
+    for (size_t i = 0; i < Ops; ++i) {
+        hits[i] = static_cast<int>(2 * (g() % n));
+        misses[i] = static_cast<int>(2 * (g() % n) + 1);
+    }
+    size_t found = 0;
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k : hits) {
+        found += list.search(k) != nullptr;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    for (int k : misses) {
+        list.insert(k);
+        list.erase(k);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    assert(found == Ops && list.size() == n);
+    auto ns = [](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / Ops; };
+    std::cout << n << " keys : search " << ns(t1, t2) << "ns, insert + erase " << ns(t2, t3) << "ns\n";
+}
+
+// Runs a mix of lookups, inserts and erases over a prefilled key range and returns operations per second.
+template <typename Lookup, typename Insert, typename Erase>
+double readWriteMix(size_t threads, size_t opsPerThread, int keyRange, unsigned readPercent,
+                    Lookup lookup, Insert insert, Erase erase) {
+    std::vector<std::thread> workers;
+    std::atomic<size_t> hits {0};
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 g(static_cast<unsigned>(t + 1));
+            size_t local = 0;
+            for (size_t i = 0; i < opsPerThread; ++i) {
+                int key = static_cast<int>(g() % static_cast<unsigned>(keyRange));
+                unsigned dice = g() % 100;
+                if (dice < readPercent) {
+                    local += lookup(key);
+                } else if (dice % 2 == 0) {
+                    insert(key);
+                } else {
+                    erase(key);
+                }
+            }
+            hits += local;
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    return static_cast<double>(threads * opsPerThread) / std::chrono::duration<double>(t2 - t1).count();
+}
+
+int main(int argc, char* argv[]) {
+    SkipList<int> skipList(16, 0.5);
+
+    for (int i = 0; i < 10; i++) {
+        skipList.insert(i);
+    }
+    std::cout << skipList;
+
+    auto five = skipList.search(5);
+    assert(five);
+
+    skipList.insert(8);
+    std::cout << skipList;
+
+    skipList.erase(8);
+    auto eight = skipList.search(8);
+    assert(!eight);
+    std::cout << skipList;
+
+    std::vector<int> backwards(std::make_reverse_iterator(skipList.end()), std::make_reverse_iterator(skipList.begin()));
+    assert((backwards == std::vector<int> {9, 7, 6, 5, 4, 3, 2, 1, 0}));
+    assert(*skipList.lower_bound(8) == 9 && *skipList.upper_bound(6) == 7 && skipList.lower_bound(10) == skipList.end());
+
+    constexpr size_t N = 1'000'000;
+    std::mt19937 g(1);
+    std::vector<int> keys(N);
+    for (auto& k : keys) {
+        k = static_cast<int>(g() % 1'000'000'000);
+    }
+
+    SkipList<int> big(20, 0.5);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k : keys) {
+        big.insert(k);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (int k : keys) {
+        found += big.search(k) != nullptr;
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    assert(found == N);
+
+    std::set<int> tree;
+    auto t4 = std::chrono::steady_clock::now();
+    for (int k : keys) {
+        tree.insert(k);
+    }
+    auto t5 = std::chrono::steady_clock::now();
+    for (int k : keys) {
+        found += tree.count(k);
+    }
+    auto t6 = std::chrono::steady_clock::now();
+    assert(found == 2 * N);
+
+    auto ms = [](auto a, auto b) { return std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count(); };
+    std::cout << "SkipList : insert " << ms(t1, t2) << "ms, search " << ms(t2, t3) << "ms, "
+              << static_cast<double>(big.arena.bytesReserved()) / static_cast<double>(big.size()) << " bytes per node\n";
+    std::cout << "std::set : insert " << ms(t4, t5) << "ms, search " << ms(t5, t6) << "ms\n";
+
+    for (size_t i = 0; i < 10'000; ++i) {
+        int lo = static_cast<int>(g() % 1'000'000'000);
+        int hi = lo + static_cast<int>(g() % 10'000'000);
+        auto lb = big.lower_bound(lo);
+        auto ub = big.upper_bound(lo);
+        assert(lb == big.end() ? tree.lower_bound(lo) == tree.end() : *lb == *tree.lower_bound(lo));
+        assert(ub == big.end() ? tree.upper_bound(lo) == tree.end() : *ub == *tree.upper_bound(lo));
+        auto r = big.range(lo, hi);
+        assert(std::ranges::equal(r, std::ranges::subrange(tree.lower_bound(lo), tree.lower_bound(hi))));
+        if (lb != big.begin()) {
+            assert(*std::prev(lb) == *std::prev(tree.lower_bound(lo)));
+        }
+    }
+
+    // Range scans over dense keys inserted in random order, so that list order and memory order disagree.
+    {
+        constexpr int Keys = 1'000'000;
+        constexpr int Width = 10'000;
+        constexpr size_t Scans = 1'000;
+        std::vector<int> dense(Keys);
+        std::iota(dense.begin(), dense.end(), 0);
+        std::shuffle(dense.begin(), dense.end(), g);
+        SkipList<int> index(20, 0.5);
+        for (int k : dense) {
+            index.insert(k);
+        }
+        std::vector<int> starts(Scans);
+        for (auto& lo : starts) {
+            lo = static_cast<int>(g() % (Keys - Width));
+        }
+
+        long long sums[3] = {};
+        auto s1 = std::chrono::steady_clock::now();
+        for (int lo : starts) {
+            for (int k = lo; k < lo + Width; ++k) {
+                if (const Node<int>* n = index.search(k)) {
+                    sums[0] += n->key;
+                }
+            }
+        }
+        auto s2 = std::chrono::steady_clock::now();
+        for (int lo : starts) {
+            for (auto it = index.lower_bound(lo); it != index.end() && *it < lo + Width; ++it) {
+                sums[1] += *it;
+            }
+        }
+        auto s3 = std::chrono::steady_clock::now();
+        for (int lo : starts) {
+            for (int k : index.range(lo, lo + Width)) {
+                sums[2] += k;
+            }
+        }
+        auto s4 = std::chrono::steady_clock::now();
+        assert(sums[0] == sums[1] && sums[1] == sums[2]);
+
+        auto rate = [&](auto a, auto b) {
+            return static_cast<double>(Scans * Width) / std::chrono::duration<double>(b - a).count() / 1e6;
+        };
+        std::cout << "range scans of " << Width << " keys : point search " << rate(s1, s2) << " Mkeys/s, iterator "
+                  << rate(s2, s3) << " Mkeys/s, prefetching range " << rate(s3, s4) << " Mkeys/s\n";
+    }
+
+    for (size_t n : {16, 1'024, 1'048'576}) {
+        operationLatency(n);
+    }
+
+    {
+        SkipListMap<std::string, int, std::less<>> words;
+        std::map<std::string, int, std::less<>> reference;
+        std::mt19937 wg(11);
+        std::vector<std::string> pool = randomKeys(200, 3, wg);
+        for (auto& k : randomKeys(200, 12, wg)) {
+            pool.push_back(k);
+        }
+        for (size_t i = 0; i < 100'000; ++i) {
+            const std::string& k = pool[wg() % pool.size()];
+            std::string_view view = k;
+            switch (wg() % 4) {
+                case 0: assert(words.try_emplace(k, static_cast<int>(i)).second == reference.try_emplace(k, static_cast<int>(i)).second); break;
+                case 1: assert(words.erase(view) == reference.erase(k)); break;
+                case 2: assert(words.contains(view) == reference.contains(view)); break;
+                case 3: {
+                    auto lb = words.lower_bound(view);
+                    auto rb = reference.lower_bound(view);
+                    assert(lb == words.end() ? rb == reference.end() : *lb == *rb);
+                    auto ub = words.upper_bound(view);
+                    auto rub = reference.upper_bound(view);
+                    assert(ub == words.end() ? rub == reference.end() : *ub == *rub);
+                    break;
+                }
+            }
+        }
+        assert(words.size() == reference.size() && std::equal(words.begin(), words.end(), reference.begin(), reference.end()));
+
+        SkipListMap<std::pair<int, std::string>, int, std::greater<>> composite;
+        composite[{1, "b"}] = 1;
+        composite[{2, "a"}] = 2;
+        composite[{1, "c"}] = 3;
+        composite[{1, "b"}] += 10;
+        std::vector<int> order;
+        for (const auto& [k, v] : composite) {
+            order.push_back(v);
+        }
+        assert((order == std::vector<int> {2, 3, 11}) && composite.count(std::pair<int, std::string> {1, "c"}) == 1);
+    }
+
+    lsmWorkload(std::filesystem::temp_directory_path() / "skiplist-lsm", 200'000, 500'000, 100);
+    lsmTinyCompaction(std::filesystem::temp_directory_path() / "skiplist-lsm-tiny");
+
+    for (size_t length : {12, 40}) {
+        std::mt19937 wg(5);
+        std::vector<std::string> words = randomKeys(300'000, length, wg);
+        std::cout << words.size() << " keys of " << length << " characters :\n";
+        stringMapBenchmark<SkipListMap<std::string, int, std::less<>>>("SkipListMap<std::string, int, std::less<>>", words,
+            [](auto& map, std::string_view k) { return map.find(k)->second; });
+        stringMapBenchmark<std::map<std::string, int, std::less<>>>("std::map<std::string, int, std::less<>>", words,
+            [](auto& map, std::string_view k) { return map.find(k)->second; });
+        stringMapBenchmark<std::map<std::string, int>>("std::map<std::string, int>", words,
+            [](auto& map, std::string_view k) { return map.find(std::string(k))->second; });
+    }
+
+    // Loading a sorted snapshot: n inserts against one linear build, then lookups and a full scan of the result.
+    {
+        constexpr int Keys = 2'000'000;
+        std::vector<int> sorted(Keys);
+        for (int i = 0; i < Keys; ++i) {
+            sorted[i] = 2 * i;
+        }
+        std::vector<int> probes(sorted);
+        std::shuffle(probes.begin(), probes.end(), g);
+
+        SkipList<int> small(8, 0.5);
+        std::vector<int> dups {1, 1, 2, 3, 3, 3, 5};
+        small.buildFromSorted(dups.begin(), dups.end(), LevelAssignment::Deterministic);
+        assert((std::vector<int>(small.begin(), small.end()) == std::vector<int> {1, 2, 3, 5}));
+        assert(small.size() == 4 && small.head->forward()[1] && *std::prev(small.end()) == 5);
+
+        auto report = [&](const char* name, auto build) {
+            SkipList<int> list(24, 0.5);
+            auto b1 = std::chrono::steady_clock::now();
+            build(list);
+            auto b2 = std::chrono::steady_clock::now();
+            size_t found = 0;
+            for (int k : probes) {
+                found += list.search(k) != nullptr;
+            }
+            auto b3 = std::chrono::steady_clock::now();
+            long long sum = 0;
+            for (int k : list.range(0, 2 * Keys)) {
+                sum += k;
+            }
+            auto b4 = std::chrono::steady_clock::now();
+            assert(found == Keys && sum == static_cast<long long>(Keys) * (Keys - 1));
+            std::cout << name << " : build " << ms(b1, b2) << "ms, " << Keys << " searches " << ms(b2, b3)
+                      << "ms, full scan " << ms(b3, b4) << "ms\n";
+        };
+        report("insert loop", [&](SkipList<int>& list) {
+            for (int k : sorted) {
+                list.insert(k);
+            }
+        });
+        report("buildFromSorted, random levels", [&](SkipList<int>& list) {
+            list.buildFromSorted(sorted.begin(), sorted.end());
+        });
+        report("buildFromSorted, deterministic levels", [&](SkipList<int>& list) {
+            list.buildFromSorted(sorted.begin(), sorted.end(), LevelAssignment::Deterministic);
+        });
+    }
+
+    {
+        ConcurrentSkipList<int> shared(16, 0.5);
+        linearizabilityStress(shared, 4, 2000);
+    }
+
+    constexpr int KeyRange = 100'000;
+    constexpr size_t Ops = 400'000;
+    size_t maxThreads = std::max<size_t>(4, std::thread::hardware_concurrency());
+    for (unsigned readPercent : {90u, 50u}) {
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            ConcurrentSkipList<int> lockFree(20, 0.5);
+            SkipList<int> locked(20, 0.5);
+            std::mutex m;
+            for (int k = 0; k < KeyRange; k += 2) {
+                lockFree.insert(k);
+                locked.insert(k);
+            }
+            double lf = readWriteMix(threads, Ops / threads, KeyRange, readPercent,
+                                     [&](int k) { return lockFree.contains(k); },
+                                     [&](int k) { lockFree.insert(k); },
+                                     [&](int k) { lockFree.erase(k); });
+            double lk = readWriteMix(threads, Ops / threads, KeyRange, readPercent,
+                                     [&](int k) { std::lock_guard<std::mutex> lock(m); return locked.search(k) != nullptr; },
+                                     [&](int k) { std::lock_guard<std::mutex> lock(m); locked.insert(k); },
+                                     [&](int k) { std::lock_guard<std::mutex> lock(m); locked.erase(k); });
+            std::cout << readPercent << "% reads, " << threads << " threads : ConcurrentSkipList "
+                      << lf / 1e6 << " Mops/s, SkipList + mutex " << lk / 1e6 << " Mops/s\n";
+        }
+    }
+
+    // The sorted-insertion experiment of 20-20, with this file's container as a contender. It takes the
+    // same options as 20-20: --csv or --json, --repetitions=N, --warmup=N, --no-flush, --no-counters.
+    BenchmarkSuite suite(BenchmarkOptions::fromArgs(argc, argv));
+    for (size_t n : {128, 512, 2048}) {
+        addSortedInsert<std::set<int>>(suite, "std::set", n);
+        addSortedInsert<SkipList<int>>(suite, "SkipList", n, [] { return std::make_unique<SkipList<int>>(16, 0.5f); });
+    }
+    suite.run();
+    suite.write(std::cout);
 
-    skipList.erase(8);
-    auto eight = skipList.search(8);
-    assert(!eight);
-    std::cout << skipList;
 }
\ No newline at end of file
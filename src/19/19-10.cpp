@@ -1,6 +1,13 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <iostream>
 #include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
 #include <utility>
 
 template<typename T, typename Deleter = std::default_delete<T>>
@@ -14,27 +21,28 @@ public:
 private:
     std::pair<pointer, deleter_type> ptr;
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+public:
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr() noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr(std::nullptr_t) noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     explicit UniquePtr(pointer p) noexcept : ptr(p, deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_constructible_v<Deleter, Deleter &>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_constructible_v<D, D &>, bool> = true>
     UniquePtr(pointer p, Deleter &d) noexcept : ptr(p, d) {}
 
-    template<std::enable_if_t<!std::is_reference_v<Deleter> && std::is_constructible_v<Deleter, Deleter &&>, bool>>
+    template<typename D = Deleter, std::enable_if_t<!std::is_reference_v<D> && std::is_constructible_v<D, D &&>, bool> = true>
     UniquePtr(pointer p, Deleter &&d) noexcept : ptr(p, std::move(d)) {}
 
     UniquePtr(UniquePtr &&u) noexcept: ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
             std::enable_if_t<(std::is_reference_v<Deleter> && std::is_same_v<Deleter, Deleter2>)
-                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool>>
+                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool> = true>
     UniquePtr(UniquePtr<U, Deleter2> &&u) noexcept : ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     UniquePtr &operator=(UniquePtr &&u) noexcept {
@@ -44,8 +52,8 @@ private:
     }
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
-            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool>>
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
+            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool> = true>
     UniquePtr &operator=(UniquePtr<U, Deleter2> &&u) noexcept {
         reset(u.release());
         ptr.second = std::forward<Deleter2>(u.getDeleter());
@@ -97,8 +105,263 @@ private:
         }
     }
 
+};
+
+// Bytes taken by n elements of T. A count whose size does not fit in size_t throws, as new T[n] does,
+// instead of wrapping around to a small allocation.
+template<typename T>
+size_t arrayBytes(size_t n) {
+    if (n > SIZE_MAX / sizeof(T)) {
+        throw std::bad_array_new_length();
+    }
+    return n * sizeof(T);
+}
+
+// Frees arrays obtained from makeUnique<T[]> and makeUniqueForOverwrite<T[]>; the length lets it
+// destroy the elements and hand the exact size back to operator delete. A length that no allocation
+// could have had ends in std::terminate rather than in a mismatched size.
+template<typename T>
+struct SizedArrayDelete {
+    void operator()(T *p, size_t n) const noexcept {
+        size_t bytes = arrayBytes<T>(n);
+        std::destroy_n(p, n);
+        ::operator delete(static_cast<void *>(p), bytes, std::align_val_t{alignof(T)});
+    }
+};
+
+// Frees arrays obtained from allocateUnique<T[]> through the allocator that made them.
+template<typename Alloc>
+class AllocatorArrayDelete {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    Alloc alloc;
+public:
+    using pointer = typename AllocTraits::pointer;
+
+    explicit AllocatorArrayDelete(const Alloc &a = Alloc()) noexcept : alloc(a) {}
+
+    void operator()(pointer p, size_t n) noexcept {
+        for (size_t i = 0; i < n; i++) {
+            AllocTraits::destroy(alloc, std::to_address(p) + i);
+        }
+        AllocTraits::deallocate(alloc, p, n);
+    }
+};
+
+// Owns an array and remembers its length. A deleter callable as d(p, n) receives the length,
+// so sized and allocator-backed deallocation work; one callable as d(p) is called that way.
+template<typename T, typename Deleter>
+class UniquePtr<T[], Deleter> {
+public:
+    using element_type = T;
+    using deleter_type = Deleter;
+    using pointer = T *;
+    using size_type = size_t;
+    static_assert(!std::is_rvalue_reference_v<Deleter>);
+
+private:
+    std::pair<pointer, deleter_type> ptr;
+    size_type n;
+
+    void destroy(pointer p, size_type len) noexcept {
+        if constexpr (std::is_invocable_v<deleter_type &, pointer, size_type>) {
+            ptr.second(p, len);
+        } else {
+            ptr.second(p);
+        }
+    }
+
+public:
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
+    constexpr UniquePtr() noexcept : ptr(pointer(), deleter_type{}), n(0) {}
+
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
+    constexpr UniquePtr(std::nullptr_t) noexcept : ptr(pointer(), deleter_type{}), n(0) {}
+
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
+    UniquePtr(pointer p, size_type len) noexcept : ptr(p, deleter_type{}), n(len) {}
+
+    template<typename D = Deleter, std::enable_if_t<std::is_constructible_v<D, D &>, bool> = true>
+    UniquePtr(pointer p, size_type len, Deleter &d) noexcept : ptr(p, d), n(len) {}
+
+    template<typename D = Deleter, std::enable_if_t<!std::is_reference_v<D> && std::is_constructible_v<D, D &&>, bool> = true>
+    UniquePtr(pointer p, size_type len, Deleter &&d) noexcept : ptr(p, std::move(d)), n(len) {}
+
+    UniquePtr(UniquePtr &&u) noexcept: ptr(u.ptr.first, std::forward<Deleter>(u.getDeleter())), n(u.n) {
+        u.ptr.first = pointer();
+        u.n = 0;
+    }
+
+    UniquePtr &operator=(UniquePtr &&u) noexcept {
+        size_type len = u.n;
+        reset(u.release(), len);
+        ptr.second = std::forward<Deleter>(u.getDeleter());
+        return *this;
+    }
+
+    ~UniquePtr() { reset(); }
+
+    UniquePtr &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    T &operator[](size_type i) const {
+        assert(i < n);
+        return ptr.first[i];
+    }
+
+    pointer get() const noexcept {
+        return ptr.first;
+    }
+
+    size_type size() const noexcept {
+        return n;
+    }
+
+    T *begin() const noexcept {
+        return ptr.first;
+    }
+
+    T *end() const noexcept {
+        return ptr.first + n;
+    }
+
+    deleter_type &getDeleter() noexcept {
+        return ptr.second;
+    }
+
+    const deleter_type &getDeleter() const noexcept {
+        return ptr.second;
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr.first != nullptr;
+    }
+
+    pointer release() noexcept {
+        pointer t = ptr.first;
+        ptr.first = pointer();
+        n = 0;
+        return t;
+    }
+
+    void reset(pointer p = pointer(), size_type len = 0) noexcept {
+        pointer t = ptr.first;
+        size_type tn = n;
+        ptr.first = p;
+        n = len;
+        if (t) {
+            destroy(t, tn);
+        }
+    }
 
+    void reset(std::nullptr_t) noexcept {
+        reset();
+    }
 };
 
+template<typename T>
+using UniqueArray = UniquePtr<T[], SizedArrayDelete<T>>;
+
+// Gets raw storage for n elements and builds them with init, unwinding on a throw.
+template<typename T, typename Init>
+T *buildArray(size_t n, Init init) {
+    size_t bytes = arrayBytes<T>(n);
+    auto *p = static_cast<T *>(::operator new(bytes, std::align_val_t{alignof(T)}));
+    size_t i = 0;
+    try {
+        for (; i < n; i++) {
+            init(p + i);
+        }
+    } catch (...) {
+        std::destroy_n(p, i);
+        ::operator delete(static_cast<void *>(p), bytes, std::align_val_t{alignof(T)});
+        throw;
+    }
+    return p;
+}
+
+template<typename T, typename... Args, std::enable_if_t<!std::is_array_v<T>, bool> = true>
+UniquePtr<T> makeUnique(Args &&... args) {
+    return UniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Value-initialises every element, so arithmetic types start at zero.
+template<typename T, std::enable_if_t<std::is_unbounded_array_v<T>, bool> = true>
+UniqueArray<std::remove_extent_t<T>> makeUnique(size_t n) {
+    using E = std::remove_extent_t<T>;
+    return UniqueArray<E>(buildArray<E>(n, [](E *p) { ::new(static_cast<void *>(p)) E(); }), n);
+}
+
+template<typename T, std::enable_if_t<!std::is_array_v<T>, bool> = true>
+UniquePtr<T> makeUniqueForOverwrite() {
+    return UniquePtr<T>(new T);
+}
+
+// Default-initialises every element; trivial types are left as whatever the allocator returned.
+template<typename T, std::enable_if_t<std::is_unbounded_array_v<T>, bool> = true>
+UniqueArray<std::remove_extent_t<T>> makeUniqueForOverwrite(size_t n) {
+    using E = std::remove_extent_t<T>;
+    return UniqueArray<E>(buildArray<E>(n, [](E *p) { ::new(static_cast<void *>(p)) E; }), n);
+}
+
+template<typename T, typename Alloc, std::enable_if_t<std::is_unbounded_array_v<T>, bool> = true>
+auto allocateUnique(const Alloc &a, size_t n) {
+    using E = std::remove_extent_t<T>;
+    using A = typename std::allocator_traits<Alloc>::template rebind_alloc<E>;
+    using AllocTraits = std::allocator_traits<A>;
+    A alloc(a);
+    auto p = AllocTraits::allocate(alloc, n);
+    size_t i = 0;
+    try {
+        for (; i < n; i++) {
+            AllocTraits::construct(alloc, std::to_address(p) + i);
+        }
+    } catch (...) {
+        for (size_t j = 0; j < i; j++) {
+            AllocTraits::destroy(alloc, std::to_address(p) + j);
+        }
+        AllocTraits::deallocate(alloc, p, n);
+        throw;
+    }
+    return UniquePtr<E[], AllocatorArrayDelete<A>>(std::to_address(p), n, AllocatorArrayDelete<A>(alloc));
+}
+
+// Allocates and frees count buffers of n bytes and returns the average time per buffer.
+template<typename Make>
+long long bufferChurn(size_t n, size_t count, Make make) {
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        auto buf = make(n);
+        buf[n - 1] = 1;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / static_cast<long long>(count);
+}
+
 int main() {
+    auto zeroed = makeUnique<int[]>(16);
+    assert(zeroed.size() == 16 && std::all_of(zeroed.begin(), zeroed.end(), [](int x) { return x == 0; }));
+    auto moved = std::move(zeroed);
+    assert(!zeroed && moved.size() == 16);
+    bool rejected = false;
+    try {
+        auto huge = makeUnique<int64_t[]>(SIZE_MAX / 4);
+    } catch (const std::bad_array_new_length &) {
+        rejected = true;
+    }
+    assert(rejected);
+
+    auto strings = allocateUnique<std::string[]>(std::allocator<std::string>(), 4);
+    strings[3] = "owned";
+    assert(strings.size() == 4 && strings[3] == "owned");
+
+    UniquePtr<char[]> plain(new char[8], 8);
+    plain.reset();
+
+    for (size_t n : {size_t{256}, size_t{64} << 10, size_t{16} << 20}) {
+        auto unsized = bufferChurn(n, 1'000, [](size_t len) { return std::unique_ptr<char[]>(new char[len]()); });
+        auto sized = bufferChurn(n, 1'000, [](size_t len) { return makeUniqueForOverwrite<char[]>(len); });
+        std::cout << n << " bytes : new char[]() " << unsized << "ns, makeUniqueForOverwrite " << sized << "ns\n";
+    }
 }
\ No newline at end of file
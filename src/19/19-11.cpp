@@ -1,10 +1,21 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <atomic>
+#include <iostream>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <utility>
 #include <tuple>
 #include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Reclamation.h"
 
 template<typename T, typename Deleter = std::default_delete<T>>
 class UniquePtr {
@@ -17,27 +28,28 @@ public:
 private:
     std::pair<pointer, deleter_type> ptr;
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+public:
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr() noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr(std::nullptr_t) noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     explicit UniquePtr(pointer p) noexcept : ptr(p, deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_constructible_v<Deleter, Deleter &>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_constructible_v<D, D &>, bool> = true>
     UniquePtr(pointer p, Deleter &d) noexcept : ptr(p, d) {}
 
-    template<std::enable_if_t<!std::is_reference_v<Deleter> && std::is_constructible_v<Deleter, Deleter &&>, bool>>
+    template<typename D = Deleter, std::enable_if_t<!std::is_reference_v<D> && std::is_constructible_v<D, D &&>, bool> = true>
     UniquePtr(pointer p, Deleter &&d) noexcept : ptr(p, std::move(d)) {}
 
     UniquePtr(UniquePtr &&u) noexcept: ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
             std::enable_if_t<(std::is_reference_v<Deleter> && std::is_same_v<Deleter, Deleter2>)
-                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool>>
+                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool> = true>
     UniquePtr(UniquePtr<U, Deleter2> &&u) noexcept : ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     UniquePtr &operator=(UniquePtr &&u) noexcept {
@@ -47,8 +59,8 @@ private:
     }
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
-            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool>>
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
+            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool> = true>
     UniquePtr &operator=(UniquePtr<U, Deleter2> &&u) noexcept {
         reset(u.release());
         ptr.second = std::forward<Deleter2>(u.getDeleter());
@@ -101,6 +113,247 @@ private:
     }
 };
 
+// Bytes taken by n elements of T. A count whose size does not fit in size_t throws, as new T[n] does,
+// instead of wrapping around to a small allocation.
+template<typename T>
+size_t arrayBytes(size_t n) {
+    if (n > SIZE_MAX / sizeof(T)) {
+        throw std::bad_array_new_length();
+    }
+    return n * sizeof(T);
+}
+
+// Frees arrays obtained from makeUnique<T[]> and makeUniqueForOverwrite<T[]>; the length lets it
+// destroy the elements and hand the exact size back to operator delete. A length that no allocation
+// could have had ends in std::terminate rather than in a mismatched size.
+template<typename T>
+struct SizedArrayDelete {
+    void operator()(T *p, size_t n) const noexcept {
+        size_t bytes = arrayBytes<T>(n);
+        std::destroy_n(p, n);
+        ::operator delete(static_cast<void *>(p), bytes, std::align_val_t{alignof(T)});
+    }
+};
+
+// Frees arrays obtained from allocateUnique<T[]> through the allocator that made them.
+template<typename Alloc>
+class AllocatorArrayDelete {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    Alloc alloc;
+public:
+    using pointer = typename AllocTraits::pointer;
+
+    explicit AllocatorArrayDelete(const Alloc &a = Alloc()) noexcept : alloc(a) {}
+
+    void operator()(pointer p, size_t n) noexcept {
+        for (size_t i = 0; i < n; i++) {
+            AllocTraits::destroy(alloc, std::to_address(p) + i);
+        }
+        AllocTraits::deallocate(alloc, p, n);
+    }
+};
+
+// Owns an array and remembers its length. A deleter callable as d(p, n) receives the length,
+// so sized and allocator-backed deallocation work; one callable as d(p) is called that way.
+template<typename T, typename Deleter>
+class UniquePtr<T[], Deleter> {
+public:
+    using element_type = T;
+    using deleter_type = Deleter;
+    using pointer = T *;
+    using size_type = size_t;
+    static_assert(!std::is_rvalue_reference_v<Deleter>);
+
+private:
+    std::pair<pointer, deleter_type> ptr;
+    size_type n;
+
+    void destroy(pointer p, size_type len) noexcept {
+        if constexpr (std::is_invocable_v<deleter_type &, pointer, size_type>) {
+            ptr.second(p, len);
+        } else {
+            ptr.second(p);
+        }
+    }
+
+public:
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
+    constexpr UniquePtr() noexcept : ptr(pointer(), deleter_type{}), n(0) {}
+
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
+    constexpr UniquePtr(std::nullptr_t) noexcept : ptr(pointer(), deleter_type{}), n(0) {}
+
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
+    UniquePtr(pointer p, size_type len) noexcept : ptr(p, deleter_type{}), n(len) {}
+
+    template<typename D = Deleter, std::enable_if_t<std::is_constructible_v<D, D &>, bool> = true>
+    UniquePtr(pointer p, size_type len, Deleter &d) noexcept : ptr(p, d), n(len) {}
+
+    template<typename D = Deleter, std::enable_if_t<!std::is_reference_v<D> && std::is_constructible_v<D, D &&>, bool> = true>
+    UniquePtr(pointer p, size_type len, Deleter &&d) noexcept : ptr(p, std::move(d)), n(len) {}
+
+    UniquePtr(UniquePtr &&u) noexcept: ptr(u.ptr.first, std::forward<Deleter>(u.getDeleter())), n(u.n) {
+        u.ptr.first = pointer();
+        u.n = 0;
+    }
+
+    UniquePtr &operator=(UniquePtr &&u) noexcept {
+        size_type len = u.n;
+        reset(u.release(), len);
+        ptr.second = std::forward<Deleter>(u.getDeleter());
+        return *this;
+    }
+
+    ~UniquePtr() { reset(); }
+
+    UniquePtr &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    T &operator[](size_type i) const {
+        assert(i < n);
+        return ptr.first[i];
+    }
+
+    pointer get() const noexcept {
+        return ptr.first;
+    }
+
+    size_type size() const noexcept {
+        return n;
+    }
+
+    T *begin() const noexcept {
+        return ptr.first;
+    }
+
+    T *end() const noexcept {
+        return ptr.first + n;
+    }
+
+    deleter_type &getDeleter() noexcept {
+        return ptr.second;
+    }
+
+    const deleter_type &getDeleter() const noexcept {
+        return ptr.second;
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr.first != nullptr;
+    }
+
+    pointer release() noexcept {
+        pointer t = ptr.first;
+        ptr.first = pointer();
+        n = 0;
+        return t;
+    }
+
+    void reset(pointer p = pointer(), size_type len = 0) noexcept {
+        pointer t = ptr.first;
+        size_type tn = n;
+        ptr.first = p;
+        n = len;
+        if (t) {
+            destroy(t, tn);
+        }
+    }
+
+    void reset(std::nullptr_t) noexcept {
+        reset();
+    }
+};
+
+template<typename T>
+using UniqueArray = UniquePtr<T[], SizedArrayDelete<T>>;
+
+// Gets raw storage for n elements and builds them with init, unwinding on a throw.
+template<typename T, typename Init>
+T *buildArray(size_t n, Init init) {
+    size_t bytes = arrayBytes<T>(n);
+    auto *p = static_cast<T *>(::operator new(bytes, std::align_val_t{alignof(T)}));
+    size_t i = 0;
+    try {
+        for (; i < n; i++) {
+            init(p + i);
+        }
+    } catch (...) {
+        std::destroy_n(p, i);
+        ::operator delete(static_cast<void *>(p), bytes, std::align_val_t{alignof(T)});
+        throw;
+    }
+    return p;
+}
+
+template<typename T, typename... Args, std::enable_if_t<!std::is_array_v<T>, bool> = true>
+UniquePtr<T> makeUnique(Args &&... args) {
+    return UniquePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Value-initialises every element, so arithmetic types start at zero.
+template<typename T, std::enable_if_t<std::is_unbounded_array_v<T>, bool> = true>
+UniqueArray<std::remove_extent_t<T>> makeUnique(size_t n) {
+    using E = std::remove_extent_t<T>;
+    return UniqueArray<E>(buildArray<E>(n, [](E *p) { ::new(static_cast<void *>(p)) E(); }), n);
+}
+
+template<typename T, std::enable_if_t<!std::is_array_v<T>, bool> = true>
+UniquePtr<T> makeUniqueForOverwrite() {
+    return UniquePtr<T>(new T);
+}
+
+// Default-initialises every element; trivial types are left as whatever the allocator returned.
+template<typename T, std::enable_if_t<std::is_unbounded_array_v<T>, bool> = true>
+UniqueArray<std::remove_extent_t<T>> makeUniqueForOverwrite(size_t n) {
+    using E = std::remove_extent_t<T>;
+    return UniqueArray<E>(buildArray<E>(n, [](E *p) { ::new(static_cast<void *>(p)) E; }), n);
+}
+
+template<typename T, typename Alloc, std::enable_if_t<std::is_unbounded_array_v<T>, bool> = true>
+auto allocateUnique(const Alloc &a, size_t n) {
+    using E = std::remove_extent_t<T>;
+    using A = typename std::allocator_traits<Alloc>::template rebind_alloc<E>;
+    using AllocTraits = std::allocator_traits<A>;
+    A alloc(a);
+    auto p = AllocTraits::allocate(alloc, n);
+    size_t i = 0;
+    try {
+        for (; i < n; i++) {
+            AllocTraits::construct(alloc, std::to_address(p) + i);
+        }
+    } catch (...) {
+        for (size_t j = 0; j < i; j++) {
+            AllocTraits::destroy(alloc, std::to_address(p) + j);
+        }
+        AllocTraits::deallocate(alloc, p, n);
+        throw;
+    }
+    return UniquePtr<E[], AllocatorArrayDelete<A>>(std::to_address(p), n, AllocatorArrayDelete<A>(alloc));
+}
+
+template <typename Alloc>
+class AllocatorDestructor {
+    using AllocTraits = std::allocator_traits<Alloc>;
+public:
+    using pointer = typename AllocTraits::pointer;
+    using size_type = typename AllocTraits::size_type;
+private:
+    Alloc& alloc;
+    size_type s;
+public:
+    AllocatorDestructor(Alloc& a, size_type s) noexcept : alloc(a), s(s) {}
+    void operator()(pointer p) noexcept {AllocTraits::deallocate(alloc, p, s);}
+};
+
+// Atomic counts may be shared between threads. SingleThreaded counts replace the locked
+// read-modify-write with a plain load and store, so every owner must stay on one thread.
+enum class RefCountPolicy {
+    Atomic,
+    SingleThreaded
+};
+
 class SharedCount {
     SharedCount(const SharedCount &);
 
@@ -108,22 +361,42 @@ class SharedCount {
 
 protected:
     std::atomic<long> shared_owners;
+    RefCountPolicy policy;
 
     virtual ~SharedCount() = default;
 
+    // Taking a new reference only requires an existing one, so the increment can be relaxed.
+    static void increment(std::atomic<long> &c, RefCountPolicy p) noexcept {
+        if (p == RefCountPolicy::SingleThreaded) {
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            c.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // The last owner must see every write made through the other owners before it destroys anything.
+    static long decrement(std::atomic<long> &c, RefCountPolicy p) noexcept {
+        if (p == RefCountPolicy::SingleThreaded) {
+            long n = c.load(std::memory_order_relaxed) - 1;
+            c.store(n, std::memory_order_relaxed);
+            return n;
+        }
+        return c.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
 private:
     virtual void onZeroShared() noexcept = 0;
 
 public:
-    explicit SharedCount(long refs = 0) noexcept: shared_owners(refs) {}
+    explicit SharedCount(long refs = 0, RefCountPolicy p = RefCountPolicy::Atomic) noexcept
+            : shared_owners(refs), policy(p) {}
 
     void addShared() noexcept {
-        shared_owners++;
+        increment(shared_owners, policy);
     }
 
     bool releaseShared() noexcept {
-        shared_owners--;
-        if (shared_owners == -1) {
+        if (decrement(shared_owners, policy) == -1) {
             onZeroShared();
             return true;
         }
@@ -131,7 +404,7 @@ public:
     }
 
     long useCount() const noexcept {
-        return shared_owners + 1;
+        return shared_owners.load(std::memory_order_relaxed) + 1;
     }
 };
 
@@ -145,12 +418,21 @@ protected:
     ~SharedWeakCount() override = default;
 
 public:
+    // Only valid before the control block is handed to a second owner.
+    void setRefCountPolicy(RefCountPolicy p) noexcept {
+        policy = p;
+    }
+
+    RefCountPolicy refCountPolicy() const noexcept {
+        return policy;
+    }
+
     void addShared() noexcept {
         SharedCount::addShared();
     }
 
     void addWeak() noexcept {
-        shared_weak_owners++;
+        increment(shared_weak_owners, policy);
     }
 
     void releaseShared() noexcept {
@@ -169,17 +451,22 @@ public:
 };
 
 void SharedWeakCount::releaseWeak() noexcept {
-    if (std::atomic_load(&shared_weak_owners) == 0) {
+    if (shared_weak_owners.load(std::memory_order_acquire) == 0) {
         onZeroSharedWeak();
-    } else if (--shared_weak_owners == -1) {
+    } else if (decrement(shared_weak_owners, policy) == -1) {
         onZeroSharedWeak();
     }
 }
 
 SharedWeakCount *SharedWeakCount::lock() noexcept {
-    long object_owners = std::atomic_load(&shared_weak_owners);
+    long object_owners = shared_owners.load(std::memory_order_relaxed);
     while (object_owners != -1) {
-        if (std::atomic_compare_exchange_weak(&shared_owners, &object_owners, object_owners + 1)) {
+        if (policy == RefCountPolicy::SingleThreaded) {
+            shared_owners.store(object_owners + 1, std::memory_order_relaxed);
+            return this;
+        }
+        if (shared_owners.compare_exchange_weak(object_owners, object_owners + 1, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
             return this;
         }
     }
@@ -207,8 +494,8 @@ void SharedPtrPointer<T, D, Alloc>::onZeroShared() noexcept {
 
 template<typename T, typename D, typename Alloc>
 void SharedPtrPointer<T, D, Alloc>::onZeroSharedWeak() noexcept {
-    using Al = typename Alloc::template rebind<SharedPtrPointer>::other;
-    using ATraits = std::allocator_traits<Alloc>;
+    using Al = typename std::allocator_traits<Alloc>::template rebind_alloc<SharedPtrPointer>;
+    using ATraits = std::allocator_traits<Al>;
     using PTraits = std::pointer_traits<typename ATraits::pointer>;
 
     Al a(data.second);
@@ -243,8 +530,8 @@ void SharedPtrEmplace<T, Alloc>::onZeroShared() noexcept {
 
 template<typename T, typename Alloc>
 void SharedPtrEmplace<T, Alloc>::onZeroSharedWeak() noexcept {
-    using Al = typename Alloc::template rebind<SharedPtrPointer>::other;
-    using ATraits = std::allocator_traits<Alloc>;
+    using Al = typename std::allocator_traits<Alloc>::template rebind_alloc<SharedPtrEmplace>;
+    using ATraits = std::allocator_traits<Al>;
     using PTraits = std::pointer_traits<typename ATraits::pointer>;
 
     Al a(data.first);
@@ -259,6 +546,9 @@ class WeakPtr;
 template<typename T>
 class enableSharedFromThis;
 
+template<typename T>
+class AtomicSharedPtr;
+
 template<typename T>
 class SharedPtr {
 public:
@@ -391,7 +681,7 @@ public:
         return r;
     }
 
-    template<typename Alloc, typename... Args>
+    template<RefCountPolicy Policy = RefCountPolicy::Atomic, typename Alloc, typename... Args>
     static SharedPtr<T> allocateShared(const Alloc &a, Args &&... args);
 
 private:
@@ -413,6 +703,10 @@ private:
     template<typename U>
     friend
     class WeakPtr;
+
+    template<typename U>
+    friend
+    class AtomicSharedPtr;
 };
 
 template<typename T>
@@ -426,7 +720,7 @@ template<typename U, std::enable_if_t<std::is_convertible_v<U *, T *>, bool>>
 SharedPtr<T>::SharedPtr(U *p) : ptr(p) {
     UniquePtr<U> hold(p);
     using Alloc = typename std::allocator<U>;
-    using ControlBlock = SharedPtrPointer<U, std::default_delete<U>, Alloc>;
+    using ControlBlock = SharedPtrPointer<U *, std::default_delete<U>, Alloc>;
     cntrl = new ControlBlock(p, std::default_delete<U>(), Alloc());
     hold.release();
     enableWeakThis(p, p);
@@ -437,8 +731,8 @@ template<typename U, typename Deleter, std::enable_if_t<std::is_convertible_v<U
 SharedPtr<T>::SharedPtr(U *p, Deleter d) : ptr(p) {
     try {
         using Alloc = typename std::allocator<U>;
-        using ControlBlock = SharedPtrPointer<U, std::default_delete<U>, Alloc>;
-        cntrl = new ControlBlock(p, std::default_delete<U>(), Alloc());
+        using ControlBlock = SharedPtrPointer<U *, Deleter, Alloc>;
+        cntrl = new ControlBlock(p, d, Alloc());
         enableWeakThis(p, p);
     } catch (...) {
         d(p);
@@ -464,9 +758,9 @@ template<typename Deleter, typename Alloc>
 SharedPtr<T>::SharedPtr(std::nullptr_t p, Deleter d, Alloc a) : ptr(0) {
     try {
         using ControlBlock = SharedPtrPointer<std::nullptr_t, Deleter, Alloc>;
-        using Alloc2 = typename Alloc::template rebind<ControlBlock>::other;
+        using Alloc2 = typename std::allocator_traits<Alloc>::template rebind_alloc<ControlBlock>;
         Alloc2 a2(a);
-        UniquePtr<ControlBlock, Deleter> hold2(a2.allocate(1), Deleter(a2, 1));
+        UniquePtr<ControlBlock, AllocatorDestructor<Alloc2>> hold2(a2.allocate(1), AllocatorDestructor<Alloc2>(a2, 1));
         ::new(static_cast<void *>(std::addressof(*hold2.get()))) ControlBlock(p, d, a);
         cntrl = std::addressof(*hold2.release());
         enableWeakThis(p, p);
@@ -481,9 +775,9 @@ template<typename U, typename Deleter, typename Alloc, std::enable_if_t<std::is_
 SharedPtr<T>::SharedPtr(U *p, Deleter d, Alloc a) : ptr(p) {
     try {
         using ControlBlock = SharedPtrPointer<U, Deleter, Alloc>;
-        using Alloc2 = typename Alloc::template rebind<ControlBlock>::other;
+        using Alloc2 = typename std::allocator_traits<Alloc>::template rebind_alloc<ControlBlock>;
         Alloc2 a2(a);
-        UniquePtr<ControlBlock, Deleter> hold2(a2.allocate(1), Deleter(a2, 1));
+        UniquePtr<ControlBlock, AllocatorDestructor<Alloc2>> hold2(a2.allocate(1), AllocatorDestructor<Alloc2>(a2, 1));
         ::new(static_cast<void *>(std::addressof(*hold2.get()))) ControlBlock(p, d, a);
         cntrl = std::addressof(*hold2.release());
         enableWeakThis(p, p);
@@ -552,14 +846,15 @@ SharedPtr<T>::SharedPtr(UniquePtr<U, Deleter> &&r) : ptr(r.get()) {
 }
 
 template<typename T>
-template<typename Alloc, typename... Args>
+template<RefCountPolicy Policy, typename Alloc, typename... Args>
 SharedPtr<T> SharedPtr<T>::allocateShared(const Alloc &a, Args &&... args) {
     static_assert(std::is_constructible_v<T, Args...>);
     using ControlBlock = SharedPtrEmplace<T, Alloc>;
-    using Alloc2 = typename Alloc::template rebind<ControlBlock>::other;
+    using Alloc2 = typename std::allocator_traits<Alloc>::template rebind_alloc<ControlBlock>;
     Alloc2 a2(a);
-    UniquePtr<ControlBlock, std::default_delete<T>> hold2(a2.allocate(1), Deleter(a2, 1));
+    UniquePtr<ControlBlock, AllocatorDestructor<Alloc2>> hold2(a2.allocate(1), AllocatorDestructor<Alloc2>(a2, 1));
     ::new(static_cast<void *>(std::addressof(*hold2.get()))) ControlBlock(a, std::forward<Args>(args)...);
+    hold2.get()->setRefCountPolicy(Policy);
     SharedPtr<T> r;
     r.ptr = hold2.get()->get();
     r.cntrl = std::addressof(*hold2.release());
@@ -568,7 +863,7 @@ SharedPtr<T> SharedPtr<T>::allocateShared(const Alloc &a, Args &&... args) {
 }
 
 template<typename T>
-SharedPtr<T>::~SharedPtr<T>() {
+SharedPtr<T>::~SharedPtr() {
     if (cntrl) {
         cntrl->releaseShared();
     }
@@ -643,23 +938,24 @@ SharedPtr<T>::reset(U *p, Deleter d, Alloc a) noexcept {
     SharedPtr(p, d, a).swap(*this);
 }
 
-template<typename T, typename... Args>
+template<typename T, RefCountPolicy Policy = RefCountPolicy::Atomic, typename... Args>
 inline typename std::enable_if_t<!std::is_array_v<T>, SharedPtr<T>>
 makeShared(Args &&... args) {
     static_assert(std::is_constructible_v<T, Args...>);
     using ControlBlock = SharedPtrEmplace<T, std::allocator<T>>;
     using Alloc2 = std::allocator<ControlBlock>;
     Alloc2 a2;
-    UniquePtr<ControlBlock, std::default_delete<T>> hold2(a2.allocate(1), Deleter(a2, 1));
+    UniquePtr<ControlBlock, AllocatorDestructor<Alloc2>> hold2(a2.allocate(1), AllocatorDestructor<Alloc2>(a2, 1));
     ::new(hold2.get()) ControlBlock(a2, std::forward<Args>(args)...);
+    hold2.get()->setRefCountPolicy(Policy);
     T *ptr = hold2.get()->get();
     return SharedPtr<T>::createWithControlBlock(ptr, hold2.release());
 }
 
-template<typename T, typename Alloc, typename... Args>
+template<typename T, RefCountPolicy Policy = RefCountPolicy::Atomic, typename Alloc, typename... Args>
 inline typename std::enable_if_t<!std::is_array_v<T>, SharedPtr<T>>
 allocateShared(const Alloc &a, Args &&... args) {
-    return SharedPtr<T>::allocateShared(a, std::forward<Args>(args)...);
+    return SharedPtr<T>::template allocateShared<Policy>(a, std::forward<Args>(args)...);
 }
 
 template<typename T, typename U>
@@ -961,7 +1257,7 @@ inline void WeakPtr<T>::reset() noexcept {
 template<typename T>
 SharedPtr<T> WeakPtr<T>::lock() const noexcept {
     SharedPtr<T> r;
-    r.cntrl == cntrl ? cntrl->lock() : cntrl;
+    r.cntrl = cntrl ? cntrl->lock() : cntrl;
     if (r.cntrl) {
         r.ptr = ptr;
     }
@@ -969,5 +1265,681 @@ SharedPtr<T> WeakPtr<T>::lock() const noexcept {
 }
 
 
+template<typename T>
+class IntrusivePtr;
+
+// Base for types whose reference count lives inside the object. Derived is deleted through
+// `delete static_cast<const Derived *>(this)` when the last IntrusivePtr lets go.
+// Copying an object does not copy its count.
+template<typename Derived, RefCountPolicy Policy = RefCountPolicy::Atomic>
+class IntrusiveRefCounted {
+    mutable std::atomic<long> refs{0};
+
+protected:
+    IntrusiveRefCounted() noexcept = default;
+
+    IntrusiveRefCounted(const IntrusiveRefCounted &) noexcept {}
+
+    IntrusiveRefCounted &operator=(const IntrusiveRefCounted &) noexcept {
+        return *this;
+    }
+
+    ~IntrusiveRefCounted() = default;
+
+public:
+    long useCount() const noexcept {
+        return refs.load(std::memory_order_relaxed);
+    }
+
+    // The object must already be owned by an IntrusivePtr, or be about to be.
+    IntrusivePtr<Derived> intrusiveFromThis() noexcept {
+        return IntrusivePtr<Derived>(static_cast<Derived *>(this));
+    }
+
+    IntrusivePtr<const Derived> intrusiveFromThis() const noexcept {
+        return IntrusivePtr<const Derived>(static_cast<const Derived *>(this));
+    }
+
+    friend void intrusivePtrAddRef(const IntrusiveRefCounted *p) noexcept {
+        if constexpr (Policy == RefCountPolicy::SingleThreaded) {
+            p->refs.store(p->refs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            p->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    friend void intrusivePtrRelease(const IntrusiveRefCounted *p) noexcept {
+        long n;
+        if constexpr (Policy == RefCountPolicy::SingleThreaded) {
+            n = p->refs.load(std::memory_order_relaxed) - 1;
+            p->refs.store(n, std::memory_order_relaxed);
+        } else {
+            n = p->refs.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        }
+        if (n == 0) {
+            delete static_cast<const Derived *>(p);
+        }
+    }
+};
+
+// One pointer wide; the count is reached through intrusivePtrAddRef and intrusivePtrRelease,
+// found by argument-dependent lookup, so any type can opt in without deriving from IntrusiveRefCounted.
+template<typename T>
+class IntrusivePtr {
+public:
+    using element_type = T;
+
+private:
+    element_type *ptr;
+
+public:
+    constexpr IntrusivePtr() noexcept: ptr(nullptr) {}
+
+    constexpr IntrusivePtr(std::nullptr_t) noexcept: ptr(nullptr) {}
+
+    IntrusivePtr(element_type *p, bool addRef = true) noexcept: ptr(p) {
+        if (ptr && addRef) {
+            intrusivePtrAddRef(ptr);
+        }
+    }
+
+    IntrusivePtr(const IntrusivePtr &r) noexcept: IntrusivePtr(r.ptr) {}
+
+    template<typename U, std::enable_if_t<std::is_convertible_v<U *, element_type *>, bool> = false>
+    IntrusivePtr(const IntrusivePtr<U> &r) noexcept : IntrusivePtr(r.get()) {}
+
+    IntrusivePtr(IntrusivePtr &&r) noexcept: ptr(r.ptr) {
+        r.ptr = nullptr;
+    }
+
+    template<typename U, std::enable_if_t<std::is_convertible_v<U *, element_type *>, bool> = false>
+    IntrusivePtr(IntrusivePtr<U> &&r) noexcept : ptr(r.detach()) {}
+
+    ~IntrusivePtr() {
+        if (ptr) {
+            intrusivePtrRelease(ptr);
+        }
+    }
+
+    IntrusivePtr &operator=(const IntrusivePtr &r) noexcept {
+        IntrusivePtr(r).swap(*this);
+        return *this;
+    }
+
+    IntrusivePtr &operator=(IntrusivePtr &&r) noexcept {
+        IntrusivePtr(std::move(r)).swap(*this);
+        return *this;
+    }
+
+    void swap(IntrusivePtr &r) noexcept {
+        std::swap(ptr, r.ptr);
+    }
+
+    void reset() noexcept {
+        IntrusivePtr().swap(*this);
+    }
+
+    void reset(element_type *p) noexcept {
+        IntrusivePtr(p).swap(*this);
+    }
+
+    // Gives up ownership without releasing the reference.
+    element_type *detach() noexcept {
+        element_type *t = ptr;
+        ptr = nullptr;
+        return t;
+    }
+
+    element_type *get() const noexcept { return ptr; }
+
+    element_type &operator*() const noexcept { return *ptr; }
+
+    element_type *operator->() const noexcept { return ptr; }
+
+    explicit operator bool() const noexcept {
+        return ptr != nullptr;
+    }
+};
+
+template<typename T, typename... Args>
+inline IntrusivePtr<T> makeIntrusive(Args &&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+template<typename T, typename U>
+inline bool operator==(const IntrusivePtr<T> &x, const IntrusivePtr<U> &y) noexcept {
+    return x.get() == y.get();
+}
+
+template<typename T, typename U>
+inline bool operator!=(const IntrusivePtr<T> &x, const IntrusivePtr<U> &y) noexcept {
+    return !(x == y);
+}
+
+template<typename T>
+inline bool operator==(const IntrusivePtr<T> &x, std::nullptr_t) noexcept {
+    return !x;
+}
+
+template<typename T>
+inline bool operator!=(const IntrusivePtr<T> &x, std::nullptr_t) noexcept {
+    return static_cast<bool>(x);
+}
+
+// Size-class pool for small, short-lived blocks such as SharedPtrEmplace control blocks.
+// Each thread allocates from its own cache without synchronization. A block freed on another thread
+// is pushed onto its owning cache's remote list, which the owner takes over in one exchange when its
+// local list runs dry. Blocks never go back to the heap: the cache of an exited thread, with all of its
+// blocks, is handed to the next thread that starts allocating.
+class SizeClassPool {
+public:
+    static constexpr size_t Granularity = 16;
+    static constexpr size_t MaxBlock = 512;
+    static constexpr size_t SlabBytes = 64 * 1024;
+
+    static void *allocate(size_t bytes) {
+        assert(bytes <= MaxBlock);
+        size_t c = sizeClass(bytes);
+        Cache &cache = local();
+        FreeBlock *b = cache.local[c];
+        if (!b) {
+            b = cache.remote[c].exchange(nullptr, std::memory_order_acquire);
+        }
+        if (b) {
+            cache.local[c] = b->next;
+            return b;
+        }
+        return carve(cache, c);
+    }
+
+    static void deallocate(void *p) noexcept {
+        auto *b = static_cast<FreeBlock *>(p);
+        Header *h = headerOf(p);
+        if (h->owner == current()) {
+            b->next = h->owner->local[h->sizeClass];
+            h->owner->local[h->sizeClass] = b;
+            return;
+        }
+        auto &remote = h->owner->remote[h->sizeClass];
+        b->next = remote.load(std::memory_order_relaxed);
+        while (!remote.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+private:
+    static constexpr size_t Classes = MaxBlock / Granularity;
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    struct Cache;
+
+    // Written once when a block is carved; it routes every later free to the right list.
+    struct alignas(Granularity) Header {
+        Cache *owner;
+        size_t sizeClass;
+    };
+
+    struct Cache {
+        FreeBlock *local[Classes]{};
+        std::atomic<FreeBlock *> remote[Classes]{};
+        std::byte *cursor = nullptr;
+        std::byte *slabEnd = nullptr;
+    };
+
+    struct Registry {
+        std::mutex m;
+        std::vector<Cache *> idle;
+    };
+
+    struct ThreadCache {
+        Cache *cache;
+
+        ThreadCache() {
+            std::lock_guard<std::mutex> lock(registry().m);
+            if (registry().idle.empty()) {
+                cache = new Cache;
+            } else {
+                cache = registry().idle.back();
+                registry().idle.pop_back();
+            }
+        }
+
+        ~ThreadCache() {
+            std::lock_guard<std::mutex> lock(registry().m);
+            registry().idle.push_back(cache);
+            current() = nullptr;
+        }
+    };
+
+    static Registry &registry() {
+        static Registry *r = new Registry;
+        return *r;
+    }
+
+    static Cache *&current() noexcept {
+        static thread_local Cache *c = nullptr;
+        return c;
+    }
+
+    static Cache &local() {
+        Cache *&c = current();
+        if (!c) {
+            static thread_local ThreadCache t;
+            c = t.cache;
+        }
+        return *c;
+    }
+
+    static size_t sizeClass(size_t bytes) noexcept {
+        return bytes == 0 ? 0 : (bytes - 1) / Granularity;
+    }
+
+    static Header *headerOf(void *p) noexcept {
+        return reinterpret_cast<Header *>(static_cast<std::byte *>(p) - sizeof(Header));
+    }
+
+    static void *carve(Cache &cache, size_t c) {
+        size_t block = sizeof(Header) + (c + 1) * Granularity;
+        if (static_cast<size_t>(cache.slabEnd - cache.cursor) < block) {
+            cache.cursor = static_cast<std::byte *>(::operator new(SlabBytes, std::align_val_t{Granularity}));
+            cache.slabEnd = cache.cursor + SlabBytes;
+        }
+        auto *h = ::new(cache.cursor) Header{&cache, c};
+        cache.cursor += block;
+        return h + 1;
+    }
+};
+
+// Stateless allocator over SizeClassPool; larger or over-aligned requests go to ::operator new.
+// Any instance can free memory from any other, on any thread.
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = PoolAllocator<U>;
+    };
+
+    PoolAllocator() noexcept = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+    [[nodiscard]] T *allocate(size_t n) {
+        if (pooled(n)) {
+            return static_cast<T *>(SizeClassPool::allocate(n * sizeof(T)));
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        if (pooled(n)) {
+            SizeClassPool::deallocate(p);
+        } else {
+            ::operator delete(p, std::align_val_t{alignof(T)});
+        }
+    }
+
+private:
+    static bool pooled(size_t n) noexcept {
+        return alignof(T) <= SizeClassPool::Granularity && n <= SizeClassPool::MaxBlock / sizeof(T);
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) noexcept {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) noexcept {
+    return false;
+}
+
+// makeShared with the control block and object carved from the calling thread's SizeClassPool cache.
+template<typename T, RefCountPolicy Policy = RefCountPolicy::Atomic, typename... Args>
+inline typename std::enable_if_t<!std::is_array_v<T>, SharedPtr<T>>
+makeSharedPooled(Args &&... args) {
+    return allocateShared<T, Policy>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+template<RefCountPolicy Policy>
+void copyDestroy(const char *name, size_t n) {
+    auto p = makeShared<int, Policy>(1);
+    std::vector<SharedPtr<int>> copies(64);
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) {
+        copies[i % copies.size()] = p;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    assert(p.useCount() == 1 + static_cast<long>(std::min(n, copies.size())));
+    auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
+    std::cout << name << " : " << static_cast<double>(dt.count()) / n << "ns per copy/destroy\n";
+}
+
+// A SharedPtr slot that threads can load and replace concurrently without a lock.
+// Each stored value lives in an immutable Box. A writer swaps in a new Box with one exchange and
+// retires the old one to the EpochDomain, so a reader only pins its epoch and never writes to the slot.
+// load() still bumps the value's own count to hand out a copy; visit() reads in place and skips that too.
+template<typename T>
+class AtomicSharedPtr {
+    struct Box {
+        SharedPtr<T> value;
+
+        explicit Box(SharedPtr<T> v) noexcept: value(std::move(v)) {}
+    };
+
+    std::atomic<Box *> box;
+
+    static Box *makeBox(SharedPtr<T> v) {
+        assert(!v.cntrl || v.cntrl->refCountPolicy() == RefCountPolicy::Atomic);
+        return new Box(std::move(v));
+    }
+
+public:
+    using value_type = SharedPtr<T>;
+
+    static constexpr bool is_always_lock_free = std::atomic<Box *>::is_always_lock_free;
+
+    AtomicSharedPtr() : box(makeBox(SharedPtr<T>())) {}
+
+    AtomicSharedPtr(SharedPtr<T> desired) : box(makeBox(std::move(desired))) {}
+
+    AtomicSharedPtr(const AtomicSharedPtr &) = delete;
+
+    AtomicSharedPtr &operator=(const AtomicSharedPtr &) = delete;
+
+    ~AtomicSharedPtr() {
+        delete box.load(std::memory_order_acquire);
+    }
+
+    SharedPtr<T> load() const {
+        EpochDomain::Guard g;
+        return box.load(std::memory_order_acquire)->value;
+    }
+
+    operator SharedPtr<T>() const {
+        return load();
+    }
+
+    // Calls f with the stored SharedPtr without copying it; the reference must not escape f.
+    template<typename F>
+    decltype(auto) visit(F &&f) const {
+        EpochDomain::Guard g;
+        return std::forward<F>(f)(std::as_const(box.load(std::memory_order_acquire)->value));
+    }
+
+    void store(SharedPtr<T> desired) {
+        EpochDomain::retire(box.exchange(makeBox(std::move(desired)), std::memory_order_acq_rel));
+    }
+
+    AtomicSharedPtr &operator=(SharedPtr<T> desired) {
+        store(std::move(desired));
+        return *this;
+    }
+
+    SharedPtr<T> exchange(SharedPtr<T> desired) {
+        EpochDomain::Guard g;
+        Box *old = box.exchange(makeBox(std::move(desired)), std::memory_order_acq_rel);
+        SharedPtr<T> r = old->value;
+        EpochDomain::retire(old);
+        return r;
+    }
+
+    // Succeeds when the stored value holds the same pointer and shares ownership with expected;
+    // otherwise expected is updated to the stored value.
+    bool compareExchangeStrong(SharedPtr<T> &expected, SharedPtr<T> desired);
+
+    bool compareExchangeWeak(SharedPtr<T> &expected, SharedPtr<T> desired) {
+        return compareExchangeStrong(expected, std::move(desired));
+    }
+};
+
+template<typename T>
+bool AtomicSharedPtr<T>::compareExchangeStrong(SharedPtr<T> &expected, SharedPtr<T> desired) {
+    EpochDomain::Guard g;
+    Box *next = nullptr;
+    Box *b = box.load(std::memory_order_acquire);
+    while (true) {
+        if (b->value.get() != expected.get() || b->value.cntrl != expected.cntrl) {
+            expected = b->value;
+            delete next;
+            return false;
+        }
+        if (!next) {
+            next = makeBox(std::move(desired));
+        }
+        if (box.compare_exchange_weak(b, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            EpochDomain::retire(b);
+            return true;
+        }
+    }
+}
+
+struct Config {
+    int version;
+};
+
+// Readers load the version of the current snapshot Reads times between them while one writer keeps publishing new ones.
+template<typename Load, typename Publish>
+long long publishAndRead(unsigned readers, int reads, Load load, Publish publish) {
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int v = 1; !done.load(std::memory_order_relaxed); v++) {
+            publish(v);
+            std::this_thread::yield();
+        }
+    });
+    std::vector<std::thread> pool;
+    auto t1 = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < readers; r++) {
+        pool.emplace_back([&] {
+            int last = 0;
+            for (int i = 0; i < reads / static_cast<int>(readers); i++) {
+                int v = load();
+                assert(v >= last);
+                last = v;
+            }
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    done = true;
+    writer.join();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+}
+
+// Creates and destroys n SharedPtrs in batches and reports the rate and per-batch latency percentiles.
+template<typename Make>
+void allocationLatency(const char *name, size_t n, Make make) {
+    constexpr size_t Batch = 64;
+    std::vector<SharedPtr<Config>> live(Batch);
+    std::vector<double> perOp;
+    perOp.reserve(n / Batch);
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n / Batch; i++) {
+        auto t1 = std::chrono::steady_clock::now();
+        for (auto &p : live) {
+            p = make(static_cast<int>(i));
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        perOp.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()) / Batch);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    std::sort(perOp.begin(), perOp.end());
+    auto pct = [&](double q) { return perOp[static_cast<size_t>(q * static_cast<double>(perOp.size() - 1))]; };
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t0).count();
+    std::cout << name << " : " << static_cast<double>(n) / 1000.0 / static_cast<double>(std::max<long long>(ms, 1))
+              << "M allocations/s, p50 " << pct(0.5) << "ns, p99 " << pct(0.99) << "ns, p99.9 " << pct(0.999) << "ns\n";
+}
+
+struct IntrusiveNode : public IntrusiveRefCounted<IntrusiveNode> {
+    int id = 0;
+    std::vector<IntrusivePtr<IntrusiveNode>> edges;
+};
+
+struct SharedNode {
+    int id = 0;
+    std::vector<SharedPtr<SharedNode>> edges;
+};
+
+// Builds a graph of n nodes with k random out-edges each and times copying every edge pointer.
+template<typename Node, typename Ptr, typename Make>
+void graphCopy(const char *name, size_t n, size_t k, size_t controlBlock, Make make) {
+    std::vector<Ptr> nodes;
+    for (size_t i = 0; i < n; i++) {
+        nodes.push_back(make());
+    }
+    size_t seed = 1;
+    for (auto &node : nodes) {
+        for (size_t j = 0; j < k; j++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            node->edges.push_back(nodes[(seed >> 33) % n]);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<Ptr> copies;
+    copies.reserve(n * k);
+    for (auto &node : nodes) {
+        for (auto &e : node->edges) {
+            copies.push_back(e);
+        }
+    }
+    copies.clear();
+    auto t2 = std::chrono::steady_clock::now();
+    size_t bytes = n * (sizeof(Node) + controlBlock) + n * k * sizeof(Ptr);
+    auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
+    std::cout << name << " : " << sizeof(Ptr) << " bytes per pointer, " << bytes / n << " bytes per node, "
+              << static_cast<double>(dt.count()) / static_cast<double>(n * k) << "ns per copy/destroy\n";
+    for (auto &node : nodes) {
+        node->edges.clear();
+    }
+}
+
 int main() {
+    auto p = makeShared<int, RefCountPolicy::SingleThreaded>(3);
+    WeakPtr<int> w(p);
+    {
+        auto q = w.lock();
+        assert(q && *q == 3 && p.useCount() == 2);
+    }
+    p.reset();
+    assert(w.expired() && !w.lock());
+
+    constexpr size_t N = 100'000'000;
+    copyDestroy<RefCountPolicy::Atomic>("atomic", N);
+    copyDestroy<RefCountPolicy::SingleThreaded>("single-threaded", N);
+
+    auto node = makeIntrusive<IntrusiveNode>();
+    IntrusivePtr<IntrusiveNode> self = node->intrusiveFromThis();
+    assert(node->useCount() == 2 && self == node);
+    self.reset();
+    assert(node->useCount() == 1);
+
+    constexpr size_t Nodes = 1'000'000;
+    constexpr size_t Edges = 8;
+    using SharedNodeBlock = SharedPtrPointer<SharedNode *, std::default_delete<SharedNode>, std::allocator<SharedNode>>;
+    graphCopy<IntrusiveNode, IntrusivePtr<IntrusiveNode>>("IntrusivePtr", Nodes, Edges, 0, [] {
+        return makeIntrusive<IntrusiveNode>();
+    });
+    graphCopy<SharedNode, SharedPtr<SharedNode>>("SharedPtr", Nodes, Edges, sizeof(SharedNodeBlock), [] {
+        return SharedPtr<SharedNode>(new SharedNode);
+    });
+
+    AtomicSharedPtr<Config> current(makeShared<Config>(Config{0}));
+    auto expected = current.load();
+    bool swapped = current.compareExchangeStrong(expected, makeShared<Config>(Config{-1}));
+    assert(swapped && current.load()->version == -1);
+    swapped = current.compareExchangeStrong(expected, makeShared<Config>(Config{-2}));
+    assert(!swapped && expected->version == -1);
+    current.store(makeShared<Config>(Config{0}));
+
+    std::vector<SharedPtr<Config>> handoff;
+    std::thread([&] {
+        for (int i = 0; i < 1'000; i++) {
+            handoff.push_back(makeSharedPooled<Config>(Config{i}));
+        }
+    }).join();
+    std::vector<const Config *> freed;
+    for (auto &c : handoff) {
+        freed.push_back(c.get());
+    }
+    handoff.clear();
+    std::thread([&] {
+        auto c = makeSharedPooled<Config>(Config{0});
+        assert(std::find(freed.begin(), freed.end(), c.get()) != freed.end());
+    }).join();
+
+    constexpr size_t Allocations = 20'000'000;
+    allocationLatency("makeShared", Allocations, [](int v) { return makeShared<Config>(Config{v}); });
+    allocationLatency("makeSharedPooled", Allocations, [](int v) { return makeSharedPooled<Config>(Config{v}); });
+
+    constexpr int Reads = 2'000'000;
+    for (unsigned readers : {1u, 2u, 4u, 8u}) {
+        SharedPtr<Config> locked = makeShared<Config>(Config{0});
+        std::mutex m;
+        auto lockedMs = publishAndRead(readers, Reads, [&] {
+            std::lock_guard<std::mutex> lock(m);
+            return locked->version;
+        }, [&](int v) {
+            auto next = makeShared<Config>(Config{v});
+            std::lock_guard<std::mutex> lock(m);
+            locked = next;
+        });
+        current.store(makeShared<Config>(Config{0}));
+        auto atomicMs = publishAndRead(readers, Reads, [&] {
+            return current.load()->version;
+        }, [&](int v) {
+            current.store(makeShared<Config>(Config{v}));
+        });
+        current.store(makeShared<Config>(Config{0}));
+        auto visitMs = publishAndRead(readers, Reads, [&] {
+            return current.visit([](const SharedPtr<Config> &c) { return c->version; });
+        }, [&](int v) {
+            current.store(makeShared<Config>(Config{v}));
+        });
+        std::atomic<Config *> raw{new Config{0}};
+        auto epochMs = publishAndRead(readers, Reads, [&] {
+            EpochDomain::Guard g;
+            return raw.load(std::memory_order_acquire)->version;
+        }, [&](int v) {
+            EpochDomain::retire(UniquePtr<Config>(raw.exchange(new Config{v}, std::memory_order_acq_rel)));
+        });
+        HazardPointers::retire(raw.exchange(new Config{0}, std::memory_order_acq_rel));
+        auto hazardMs = publishAndRead(readers, Reads, [&] {
+            int v = HazardPointers::protect(0, raw)->version;
+            HazardPointers::clear(0);
+            return v;
+        }, [&](int v) {
+            HazardPointers::retire(raw.exchange(new Config{v}, std::memory_order_acq_rel));
+        });
+        delete raw.load();
+        std::cout << readers << " readers : mutex " << lockedMs << "ms, AtomicSharedPtr " << atomicMs
+                  << "ms, AtomicSharedPtr::visit " << visitMs << "ms, EpochDomain " << epochMs
+                  << "ms, HazardPointers " << hazardMs << "ms\n";
+    }
+
+    int reclaimed = 0;
+    auto counting = [&reclaimed](Config *c) {
+        reclaimed++;
+        delete c;
+    };
+    {
+        EpochDomain::Guard g;
+        for (int i = 0; i < 10; i++) {
+            EpochDomain::retire(UniquePtr<Config, decltype(counting)>(new Config{i}, counting));
+        }
+        EpochDomain::collect();
+        assert(reclaimed == 0);
+    }
+    for (int i = 0; i < 3; i++) {
+        EpochDomain::collect();
+    }
+    assert(reclaimed == 10);
 }
\ No newline at end of file
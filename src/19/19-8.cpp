@@ -1,7 +1,20 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
+#include <iostream>
 #include <limits>
+#include <list>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
 #include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include "HugePageAllocator.h"
+#include "ProfilingAllocator.h"
 
 template <typename T>
 class Allocator {
@@ -25,16 +38,78 @@ public:
         }
         return static_cast<pointer>(::operator new(n * sizeof(T)));
     }
-    constexpr void deallocate(pointer p, size_type n) noexcept {
+    constexpr void deallocate(pointer p, size_type) noexcept {
         ::operator delete(p);
     }
 
 };
 
 template <typename T, typename U>
-constexpr bool operator==(const Allocator<T>& a1, const Allocator<U>& a2) noexcept {
+constexpr bool operator==(const Allocator<T>&, const Allocator<U>&) noexcept {
     return true;
 }
 
+template <typename Alloc>
+void pointerChase(const char* name, size_t n, size_t steps, const Alloc& a = Alloc()) {
+    std::vector<size_t, Alloc> next(n, 0, a);
+    std::iota(next.begin(), next.end(), 0);
+    std::mt19937_64 gen(42);
+    for (size_t i = n - 1; i > 0; i--) {
+        std::uniform_int_distribution<size_t> dis(0, i - 1);
+        std::swap(next[i], next[dis(gen)]);
+    }
+
+    size_t curr = 0;
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < steps; i++) {
+        curr = next[curr];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
+    std::cout << name << " : " << static_cast<double>(dt.count()) / steps << "ns per hop (" << curr << ")\n";
+}
+
 int main() {
+    {
+        std::vector<int, ProfilingAllocator<int>> v(ProfilingAllocator<int>("vector pushBack"));
+        for (int i = 0; i < 100'000; i++) {
+            v.push_back(i);
+        }
+        std::list<int, ProfilingAllocator<int>> l(ProfilingAllocator<int>("list pushBack"));
+        for (int i = 0; i < 1'000; i++) {
+            l.push_back(i);
+        }
+    }
+    auto listStats = AllocationRegistry::instance().stats("list pushBack");
+    assert(listStats.allocations == 1'000 && listStats.bytesLive == 0);
+
+    {
+        std::vector<int, ProfilingAllocator<int>> a(1'000, 0, ProfilingAllocator<int>("vector a"));
+        std::vector<int, ProfilingAllocator<int>> b(ProfilingAllocator<int>("vector b"));
+        assert(a.get_allocator() != b.get_allocator());
+        b = std::move(a);
+    }
+    auto aStats = AllocationRegistry::instance().stats("vector a");
+    auto bStats = AllocationRegistry::instance().stats("vector b");
+    assert(aStats.bytesLive == 0 && bStats.bytesLive == 0 && bStats.allocations == bStats.deallocations);
+
+    constexpr size_t N = size_t {1} << 25;
+    constexpr size_t steps = 20'000'000;
+
+    pointerChase<Allocator<size_t>>("4 KB pages", N, steps);
+    pointerChase<HugePageAllocator<size_t>>("transparent 2 MB pages", N, steps);
+    pointerChase<HugePageAllocator<size_t, PagePolicy::ExplicitHuge>>("explicit 2 MB pages", N, steps);
+    pointerChase<HugePageAllocator<size_t, PagePolicy::TransparentHuge, NumaPolicy::Interleave>>("interleaved 2 MB pages", N, steps,
+            HugePageAllocator<size_t, PagePolicy::TransparentHuge, NumaPolicy::Interleave>(0b11));
+
+    auto& fallbacks = placementFallbacks();
+    std::cout << "placement fallbacks : MAP_HUGETLB " << fallbacks.hugeTlb << ", MADV_HUGEPAGE " << fallbacks.madvise
+              << ", interleave " << fallbacks.interleave << "\n";
+    try {
+        HugePageAllocator<size_t, PagePolicy::TransparentHuge, NumaPolicy::Bind> bound(0b10);
+        bound.deallocate(bound.allocate(N), N);
+        std::cout << "bind to node 1 : ok\n";
+    } catch (const std::system_error& e) {
+        std::cout << "bind to node 1 : " << e.what() << "\n";
+    }
 }
\ No newline at end of file
@@ -0,0 +1,171 @@
+#ifndef PPP_HUGEPAGEALLOCATOR_H
+#define PPP_HUGEPAGEALLOCATOR_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum class PagePolicy {
+    Default,
+    TransparentHuge,
+    ExplicitHuge
+};
+
+enum class NumaPolicy {
+    FirstTouch,
+    Bind,
+    Interleave
+};
+
+inline constexpr size_t HugePageSize = size_t {2} << 20;
+
+inline constexpr size_t hugePageRound(size_t bytes) noexcept {
+    return (bytes + HugePageSize - 1) & ~(HugePageSize - 1);
+}
+
+// Counts the requests mapHugePages could not honour, so a benchmark can tell
+// which placement it actually measured.
+struct PlacementFallbacks {
+    std::atomic<size_t> hugeTlb {0};
+    std::atomic<size_t> madvise {0};
+    std::atomic<size_t> interleave {0};
+};
+
+inline PlacementFallbacks& placementFallbacks() {
+    static PlacementFallbacks fallbacks;
+    return fallbacks;
+}
+
+// Maps a 2 MB aligned range for bytes and applies the page and NUMA policies to it.
+// Explicit hugepages fall back to transparent ones when none are reserved, and a rejected
+// interleave leaves the default first-touch placement; both are counted in placementFallbacks().
+// A rejected bind is an error, since the caller asked for memory on specific nodes.
+inline void* mapHugePages(size_t bytes, PagePolicy pages, NumaPolicy numa, unsigned long nodeMask) {
+#if defined(__linux__)
+    size_t len = hugePageRound(bytes);
+    void* p = MAP_FAILED;
+    if (pages == PagePolicy::ExplicitHuge) {
+        p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p == MAP_FAILED) {
+            placementFallbacks().hugeTlb++;
+        }
+    }
+    if (p == MAP_FAILED) {
+        size_t padded = len + HugePageSize;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        auto addr = reinterpret_cast<std::uintptr_t>(raw);
+        auto aligned = (addr + HugePageSize - 1) & ~(HugePageSize - 1);
+        if (aligned != addr) {
+            munmap(raw, aligned - addr);
+        }
+        if (addr + padded != aligned + len) {
+            munmap(reinterpret_cast<void*>(aligned + len), addr + padded - (aligned + len));
+        }
+        p = reinterpret_cast<void*>(aligned);
+        if (pages != PagePolicy::Default && madvise(p, len, MADV_HUGEPAGE) != 0) {
+            placementFallbacks().madvise++;
+        }
+    }
+    if (numa != NumaPolicy::FirstTouch && nodeMask != 0) {
+        constexpr int MpolBind = 2;
+        constexpr int MpolInterleave = 3;
+        constexpr unsigned long maxNode = std::numeric_limits<unsigned long>::digits + 1;
+        if (syscall(SYS_mbind, p, len, numa == NumaPolicy::Bind ? MpolBind : MpolInterleave, &nodeMask, maxNode, 0) != 0) {
+            if (numa == NumaPolicy::Bind) {
+                int err = errno;
+                munmap(p, len);
+                throw std::system_error(err, std::generic_category(), "mbind");
+            }
+            placementFallbacks().interleave++;
+        }
+    }
+    return p;
+#else
+    return ::operator new(bytes, std::align_val_t {HugePageSize});
+#endif
+}
+
+inline void unmapHugePages(void* p, size_t bytes) noexcept {
+#if defined(__linux__)
+    munmap(p, hugePageRound(bytes));
+#else
+    ::operator delete(p, std::align_val_t {HugePageSize});
+#endif
+}
+
+// Requests smaller than a hugepage are served by the general heap;
+// larger ones get their own 2 MB aligned mapping.
+// A nodeMask of 0 keeps the kernel's first-touch placement regardless of the NUMA policy.
+template <typename T, PagePolicy Pages = PagePolicy::TransparentHuge, NumaPolicy Numa = NumaPolicy::FirstTouch>
+class HugePageAllocator {
+public:
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, Pages, Numa>;
+    };
+
+    constexpr HugePageAllocator() noexcept : nodeMask_ {0} {}
+
+    explicit constexpr HugePageAllocator(unsigned long nodeMask) noexcept : nodeMask_ {nodeMask} {}
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U, Pages, Numa>& a) noexcept : nodeMask_ {a.nodeMask()} {}
+
+    unsigned long nodeMask() const noexcept { return nodeMask_; }
+
+    [[nodiscard]] pointer allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(value_type)) {
+            throw std::length_error("Allocate request exceeds the maximum size");
+        }
+        size_type bytes = n * sizeof(T);
+        if (bytes < HugePageSize) {
+            return static_cast<pointer>(::operator new(bytes));
+        }
+        return static_cast<pointer>(mapHugePages(bytes, Pages, Numa, nodeMask_));
+    }
+    void deallocate(pointer p, size_type n) noexcept {
+        size_type bytes = n * sizeof(T);
+        if (bytes < HugePageSize) {
+            ::operator delete(p);
+        } else {
+            unmapHugePages(p, bytes);
+        }
+    }
+
+private:
+    unsigned long nodeMask_;
+};
+
+template <typename T, typename U, PagePolicy Pages, NumaPolicy Numa>
+constexpr bool operator==(const HugePageAllocator<T, Pages, Numa>& a1, const HugePageAllocator<U, Pages, Numa>& a2) noexcept {
+    return a1.nodeMask() == a2.nodeMask();
+}
+
+template <typename T, typename U, PagePolicy Pages, NumaPolicy Numa>
+constexpr bool operator!=(const HugePageAllocator<T, Pages, Numa>& a1, const HugePageAllocator<U, Pages, Numa>& a2) noexcept {
+    return !(a1 == a2);
+}
+
+#endif //PPP_HUGEPAGEALLOCATOR_H
\ No newline at end of file
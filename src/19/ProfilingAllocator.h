@@ -0,0 +1,168 @@
+#ifndef PPP_PROFILINGALLOCATOR_H
+#define PPP_PROFILINGALLOCATOR_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+struct AllocationStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytesAllocated = 0;
+    size_t bytesLive = 0;
+    size_t bytesPeak = 0;
+    std::array<size_t, std::numeric_limits<size_t>::digits + 1> sizeHistogram {};
+    std::chrono::nanoseconds lifetimeTotal {0};
+    std::chrono::nanoseconds lifetimeMax {0};
+};
+
+// Process-wide table of allocation statistics keyed by call-site tag.
+// Tags are compared by content and must outlive the registry, so string literals are the intended use.
+class AllocationRegistry {
+public:
+    static AllocationRegistry& instance() {
+        static AllocationRegistry* registry = [] {
+            auto* r = new AllocationRegistry;
+            std::atexit([] {
+                if (instance().reportAtExit_) {
+                    instance().report(std::cerr);
+                }
+            });
+            return r;
+        }();
+        return *registry;
+    }
+
+    void setReportAtExit(bool enable) {
+        std::lock_guard<std::mutex> lock(m_);
+        reportAtExit_ = enable;
+    }
+
+    void recordAllocate(std::string_view tag, const void* p, size_t bytes) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_);
+        auto& s = stats_[tag];
+        s.allocations++;
+        s.bytesAllocated += bytes;
+        s.bytesLive += bytes;
+        s.bytesPeak = std::max(s.bytesPeak, s.bytesLive);
+        s.sizeHistogram[std::bit_width(bytes)]++;
+        born_[p] = now;
+    }
+
+    void recordDeallocate(std::string_view tag, const void* p, size_t bytes) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_);
+        auto& s = stats_[tag];
+        s.deallocations++;
+        s.bytesLive -= bytes;
+        if (auto it = born_.find(p); it != born_.end()) {
+            auto lifetime = std::chrono::duration_cast<std::chrono::nanoseconds>(now - it->second);
+            s.lifetimeTotal += lifetime;
+            s.lifetimeMax = std::max(s.lifetimeMax, lifetime);
+            born_.erase(it);
+        }
+    }
+
+    AllocationStats stats(std::string_view tag) const {
+        std::lock_guard<std::mutex> lock(m_);
+        auto it = stats_.find(tag);
+        return it != stats_.end() ? it->second : AllocationStats {};
+    }
+
+    void report(std::ostream& os) const {
+        std::lock_guard<std::mutex> lock(m_);
+        for (const auto& [tag, s] : stats_) {
+            os << "[" << tag << "] allocations : " << s.allocations
+               << ", deallocations : " << s.deallocations
+               << ", bytes : " << s.bytesAllocated
+               << ", live : " << s.bytesLive
+               << ", peak : " << s.bytesPeak << "\n";
+            if (s.deallocations > 0) {
+                os << "    lifetime mean : " << s.lifetimeTotal.count() / static_cast<long long>(s.deallocations)
+                   << "ns, max : " << s.lifetimeMax.count() << "ns\n";
+            }
+            for (size_t b = 0; b < s.sizeHistogram.size(); b++) {
+                if (s.sizeHistogram[b] > 0) {
+                    size_t lo = b == 0 ? 0 : size_t {1} << (b - 1);
+                    os << "    " << lo << "B - " << (b == 0 ? 0 : 2 * lo - 1) << "B : " << s.sizeHistogram[b] << "\n";
+                }
+            }
+        }
+    }
+
+private:
+    AllocationRegistry() = default;
+
+    mutable std::mutex m_;
+    bool reportAtExit_ = true;
+    std::map<std::string_view, AllocationStats> stats_;
+    std::unordered_map<const void*, std::chrono::steady_clock::time_point> born_;
+};
+
+// Forwards to Upstream and records every call under its tag in the AllocationRegistry.
+// Rebound copies keep the tag, so the nodes of a List are counted with the List that owns them.
+// Allocators with different tags compare unequal, so containers never hand blocks across tags.
+template <typename T, typename Upstream = std::allocator<T>>
+class ProfilingAllocator {
+public:
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = ProfilingAllocator<U, typename std::allocator_traits<Upstream>::template rebind_alloc<U>>;
+    };
+
+    ProfilingAllocator() noexcept : tag_ {"untagged"} {}
+
+    explicit ProfilingAllocator(const char* tag, const Upstream& upstream = Upstream()) noexcept
+    : tag_ {tag}, upstream_ {upstream} {}
+
+    template <typename U, typename V>
+    ProfilingAllocator(const ProfilingAllocator<U, V>& a) noexcept : tag_ {a.tag()}, upstream_ {a.upstream()} {}
+
+    const char* tag() const noexcept { return tag_; }
+    const Upstream& upstream() const noexcept { return upstream_; }
+
+    [[nodiscard]] pointer allocate(size_type n) {
+        pointer p = std::allocator_traits<Upstream>::allocate(upstream_, n);
+        AllocationRegistry::instance().recordAllocate(tag_, p, n * sizeof(T));
+        return p;
+    }
+    void deallocate(pointer p, size_type n) noexcept {
+        AllocationRegistry::instance().recordDeallocate(tag_, p, n * sizeof(T));
+        std::allocator_traits<Upstream>::deallocate(upstream_, p, n);
+    }
+
+private:
+    const char* tag_;
+    Upstream upstream_;
+};
+
+template <typename T, typename U, typename V, typename W>
+bool operator==(const ProfilingAllocator<T, V>& a1, const ProfilingAllocator<U, W>& a2) noexcept {
+    return std::string_view(a1.tag()) == a2.tag() && a1.upstream() == a2.upstream();
+}
+
+template <typename T, typename U, typename V, typename W>
+bool operator!=(const ProfilingAllocator<T, V>& a1, const ProfilingAllocator<U, W>& a2) noexcept {
+    return !(a1 == a2);
+}
+
+#endif //PPP_PROFILINGALLOCATOR_H
\ No newline at end of file
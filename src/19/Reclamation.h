@@ -0,0 +1,345 @@
+#ifndef PPP_RECLAMATION_H
+#define PPP_RECLAMATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A pointer waiting to be reclaimed, together with the deleter that will free it.
+// An empty deleter is rebuilt when the pointer is reclaimed; any other deleter is moved to the heap until then.
+class RetiredPointer {
+    void *p;
+    void *d;
+    void (*reclaim)(void *, void *) noexcept;
+
+    template<typename T, typename Deleter>
+    static void reclaimWith(void *p, void *d) noexcept {
+        if constexpr (std::is_empty_v<Deleter> && std::is_default_constructible_v<Deleter>) {
+            Deleter()(static_cast<T *>(p));
+        } else {
+            auto *deleter = static_cast<Deleter *>(d);
+            (*deleter)(static_cast<T *>(p));
+            delete deleter;
+        }
+    }
+
+public:
+    template<typename T, typename Deleter>
+    RetiredPointer(T *ptr, Deleter &&deleter) : p(ptr), d(nullptr), reclaim(&reclaimWith<T, std::decay_t<Deleter>>) {
+        if constexpr (!std::is_empty_v<std::decay_t<Deleter>> || !std::is_default_constructible_v<std::decay_t<Deleter>>) {
+            d = new std::decay_t<Deleter>(std::forward<Deleter>(deleter));
+        }
+    }
+
+    const void *get() const noexcept {
+        return p;
+    }
+
+    void operator()() const noexcept {
+        reclaim(p, d);
+    }
+};
+
+// Epoch-based reclamation. A reader pins the current global epoch for the duration of a Guard;
+// its only shared-memory cost is a store to its own record plus a fence, with no read-modify-write.
+// A pointer retired in epoch e is reclaimed once the global epoch reaches e + 2, because by then every
+// thread that could still have been reading it has left its critical section.
+// The epoch can only advance while every pinned thread has observed the current one,
+// so a thread that stays pinned delays reclamation for everyone.
+class EpochDomain {
+public:
+    static constexpr size_t MaxThreads = 256;
+    static constexpr size_t CollectThreshold = 128;
+
+    class Guard {
+    public:
+        Guard() {
+            ThreadState &t = local();
+            if (t.depth++ == 0) {
+                t.record->epoch.store(domain().global.load(std::memory_order_relaxed) | Pinned, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        Guard(const Guard &) = delete;
+
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard() {
+            ThreadState &t = local();
+            if (--t.depth == 0) {
+                t.record->epoch.store(Idle, std::memory_order_release);
+            }
+        }
+    };
+
+    template<typename T, typename Deleter = std::default_delete<T>>
+    static void retire(T *p, Deleter &&d = Deleter()) {
+        ThreadState &t = local();
+        t.retired.push_back({RetiredPointer(p, std::forward<Deleter>(d)), domain().global.load(std::memory_order_seq_cst)});
+        if (t.retired.size() >= CollectThreshold) {
+            collect();
+        }
+    }
+
+    // Takes over an owning pointer with release() and getDeleter(), such as UniquePtr.
+    template<typename Owner>
+        requires requires(Owner &u) { u.release(); u.getDeleter(); }
+    static void retire(Owner &&u) {
+        auto d = std::move(u.getDeleter());
+        retire(u.release(), std::move(d));
+    }
+
+    // Tries to advance the global epoch and reclaims what the calling thread retired at least two epochs ago.
+    static void collect() {
+        ThreadState &t = local();
+        uint64_t e = tryAdvance();
+        auto done = std::partition(t.retired.begin(), t.retired.end(), [e](const Entry &r) {
+            return r.epoch + 2 * EpochStep > e;
+        });
+        for (auto it = done; it != t.retired.end(); ++it) {
+            it->p();
+        }
+        t.retired.erase(done, t.retired.end());
+    }
+
+private:
+    static constexpr uint64_t Idle = 0;
+    static constexpr uint64_t Pinned = 1;
+    static constexpr uint64_t EpochStep = 2;
+
+    struct alignas(64) Record {
+        std::atomic<uint64_t> epoch{Idle};
+        std::atomic<bool> owned{false};
+    };
+
+    struct Entry {
+        RetiredPointer p;
+        uint64_t epoch;
+    };
+
+    struct Domain {
+        alignas(64) std::atomic<uint64_t> global{EpochStep};
+        Record records[MaxThreads];
+        std::mutex m;
+        std::vector<Entry> orphans;
+    };
+
+    struct ThreadState {
+        Record *record = nullptr;
+        unsigned depth = 0;
+        std::vector<Entry> retired;
+
+        ThreadState() {
+            for (auto &r : domain().records) {
+                bool expected = false;
+                if (!r.owned.load(std::memory_order_relaxed) && r.owned.compare_exchange_strong(expected, true)) {
+                    record = &r;
+                    return;
+                }
+            }
+            throw std::runtime_error("EpochDomain : too many threads");
+        }
+
+        ~ThreadState() {
+            if (!retired.empty()) {
+                std::lock_guard<std::mutex> lock(domain().m);
+                domain().orphans.insert(domain().orphans.end(), retired.begin(), retired.end());
+            }
+            record->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    static Domain &domain() {
+        static Domain *d = new Domain;
+        return *d;
+    }
+
+    static ThreadState &local() {
+        static thread_local ThreadState t;
+        return t;
+    }
+
+    static uint64_t tryAdvance() {
+        Domain &d = domain();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t e = d.global.load(std::memory_order_relaxed);
+        for (auto &r : d.records) {
+            uint64_t local = r.epoch.load(std::memory_order_acquire);
+            if (local != Idle && (local & ~Pinned) != e) {
+                return e;
+            }
+        }
+        if (d.global.compare_exchange_strong(e, e + EpochStep, std::memory_order_acq_rel)) {
+            e += EpochStep;
+        }
+        std::unique_lock<std::mutex> lock(d.m, std::try_to_lock);
+        if (lock.owns_lock() && !d.orphans.empty()) {
+            local().retired.insert(local().retired.end(), d.orphans.begin(), d.orphans.end());
+            d.orphans.clear();
+        }
+        return e;
+    }
+};
+
+// Hazard pointers. A reader publishes each node it is about to dereference in one of its slots,
+// and a retired pointer is reclaimed only when no slot holds it, so a published node cannot be freed
+// and reused, which also rules out ABA. Unlike epochs, a stalled reader can only hold back the few
+// nodes it has published.
+class HazardPointers {
+public:
+    static constexpr size_t SlotsPerThread = 4;
+    static constexpr size_t MaxThreads = 256;
+    static constexpr size_t CollectThreshold = 2 * SlotsPerThread * 64;
+
+    // Publishes src's value in slot i and returns it once the slot is known to cover it.
+    template<typename T>
+    static T *protect(size_t i, const std::atomic<T *> &src) {
+        auto &s = local().record->slots[i];
+        T *p = src.load(std::memory_order_acquire);
+        while (true) {
+            s.store(p, std::memory_order_seq_cst);
+            T *q = src.load(std::memory_order_acquire);
+            if (q == p) {
+                return p;
+            }
+            p = q;
+        }
+    }
+
+    // Same for a link whose low bit is a deletion mark: the node is published without the mark,
+    // and the link's value is returned with it.
+    static std::uintptr_t protect(size_t i, const std::atomic<std::uintptr_t> &src) {
+        auto &s = local().record->slots[i];
+        std::uintptr_t p = src.load(std::memory_order_acquire);
+        while (true) {
+            s.store(reinterpret_cast<const void *>(p & ~std::uintptr_t{1}), std::memory_order_seq_cst);
+            std::uintptr_t q = src.load(std::memory_order_acquire);
+            if (q == p) {
+                return p;
+            }
+            p = q;
+        }
+    }
+
+    // Publishes a node the caller already knows to be safe, such as one it holds in another slot.
+    static void set(size_t i, const void *p) noexcept {
+        local().record->slots[i].store(p, std::memory_order_seq_cst);
+    }
+
+    static void clear(size_t i) noexcept {
+        local().record->slots[i].store(nullptr, std::memory_order_release);
+    }
+
+    static void clear() noexcept {
+        for (auto &s : local().record->slots) {
+            s.store(nullptr, std::memory_order_release);
+        }
+    }
+
+    template<typename T, typename Deleter = std::default_delete<T>>
+    static void retire(T *p, Deleter &&d = Deleter()) {
+        ThreadState &t = local();
+        t.retired.emplace_back(p, std::forward<Deleter>(d));
+        if (t.retired.size() >= CollectThreshold) {
+            collect();
+        }
+    }
+
+    // Takes over an owning pointer with release() and getDeleter(), such as UniquePtr.
+    template<typename Owner>
+        requires requires(Owner &u) { u.release(); u.getDeleter(); }
+    static void retire(Owner &&u) {
+        auto d = std::move(u.getDeleter());
+        retire(u.release(), std::move(d));
+    }
+
+    // Reclaims every pointer retired by the calling thread that no slot currently holds.
+    static void collect() {
+        scan(local().retired);
+    }
+
+private:
+    struct alignas(64) Record {
+        std::atomic<const void *> slots[SlotsPerThread]{};
+        std::atomic<bool> owned{false};
+    };
+
+    struct Domain {
+        Record records[MaxThreads];
+        std::mutex m;
+        std::vector<RetiredPointer> orphans;
+    };
+
+    struct ThreadState {
+        Record *record = nullptr;
+        std::vector<RetiredPointer> retired;
+
+        ThreadState() {
+            for (auto &r : domain().records) {
+                bool expected = false;
+                if (!r.owned.load(std::memory_order_relaxed) && r.owned.compare_exchange_strong(expected, true)) {
+                    record = &r;
+                    return;
+                }
+            }
+            throw std::runtime_error("HazardPointers : too many threads");
+        }
+
+        ~ThreadState() {
+            for (auto &s : record->slots) {
+                s.store(nullptr, std::memory_order_release);
+            }
+            scan(retired);
+            if (!retired.empty()) {
+                std::lock_guard<std::mutex> lock(domain().m);
+                domain().orphans.insert(domain().orphans.end(), retired.begin(), retired.end());
+            }
+            record->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    static Domain &domain() {
+        static Domain *d = new Domain;
+        return *d;
+    }
+
+    static ThreadState &local() {
+        static thread_local ThreadState t;
+        return t;
+    }
+
+    static void scan(std::vector<RetiredPointer> &retired) {
+        {
+            std::lock_guard<std::mutex> lock(domain().m);
+            retired.insert(retired.end(), domain().orphans.begin(), domain().orphans.end());
+            domain().orphans.clear();
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<const void *> hazards;
+        for (auto &r : domain().records) {
+            for (auto &s : r.slots) {
+                if (const void *p = s.load(std::memory_order_acquire)) {
+                    hazards.push_back(p);
+                }
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+        auto done = std::partition(retired.begin(), retired.end(), [&](const RetiredPointer &r) {
+            return std::binary_search(hazards.begin(), hazards.end(), r.get());
+        });
+        for (auto it = done; it != retired.end(); ++it) {
+            (*it)();
+        }
+        retired.erase(done, retired.end());
+    }
+};
+
+#endif //PPP_RECLAMATION_H
\ No newline at end of file
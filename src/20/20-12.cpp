@@ -1,12 +1,27 @@
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
 #include <limits>
+#include <list>
+#include <random>
 #include <algorithm>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <functional>
 #include <iterator>
 #include <utility>
 #include <initializer_list>
+#include <thread>
+#include <string_view>
+#include <vector>
+
+#include "../19/ProfilingAllocator.h"
+#include "Benchmark.h"
+#include "NodePool.h"
+#include "ParallelSort.h"
 
 template<typename T, typename Deleter = std::default_delete<T>>
 class UniquePtr {
@@ -19,27 +34,28 @@ public:
 private:
     std::pair<pointer, deleter_type> ptr;
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+public:
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr() noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr(std::nullptr_t) noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     explicit UniquePtr(pointer p) noexcept : ptr(p, deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_constructible_v<Deleter, Deleter &>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_constructible_v<D, D &>, bool> = true>
     UniquePtr(pointer p, Deleter &d) noexcept : ptr(p, d) {}
 
-    template<std::enable_if_t<!std::is_reference_v<Deleter> && std::is_constructible_v<Deleter, Deleter &&>, bool>>
+    template<typename D = Deleter, std::enable_if_t<!std::is_reference_v<D> && std::is_constructible_v<D, D &&>, bool> = true>
     UniquePtr(pointer p, Deleter &&d) noexcept : ptr(p, std::move(d)) {}
 
     UniquePtr(UniquePtr &&u) noexcept: ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
             std::enable_if_t<(std::is_reference_v<Deleter> && std::is_same_v<Deleter, Deleter2>)
-                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool>>
+                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool> = true>
     UniquePtr(UniquePtr<U, Deleter2> &&u) noexcept : ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     UniquePtr &operator=(UniquePtr &&u) noexcept {
@@ -49,8 +65,8 @@ private:
     }
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
-            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool>>
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
+            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool> = true>
     UniquePtr &operator=(UniquePtr<U, Deleter2> &&u) noexcept {
         reset(u.release());
         ptr.second = std::forward<Deleter2>(u.getDeleter());
@@ -403,7 +419,7 @@ inline ListImpl<T, Alloc>::ListImpl(NodeAllocator&& a) noexcept : sizeAlloc(0, s
 {}
 
 template <typename T, typename Alloc>
-ListImpl<T, Alloc>::~ListImpl<T, Alloc>() {
+ListImpl<T, Alloc>::~ListImpl() {
     clear();
 }
 
@@ -633,6 +649,11 @@ public:
     template <typename Comp>
     void sort(Comp comp);
 
+    void parallelSort() { parallelSort(std::less<value_type>()); }
+
+    template <typename Comp>
+    void parallelSort(Comp comp, unsigned threads = std::thread::hardware_concurrency());
+
     void reverse() noexcept;
 
     bool invariants() const;
@@ -752,7 +773,7 @@ template <typename T, typename Alloc>
 List<T, Alloc>::List(const List& c)
 : base(NodeAllocTraits::select_on_container_copy_construction(c.nodeAlloc())) {
     for (const_iterator i = c.begin(), e = c.end(); i != e; ++i) {
-        push_back(*i);
+        pushBack(*i);
     }
 }
 
@@ -760,21 +781,21 @@ template <typename T, typename Alloc>
 List<T, Alloc>::List(const List& c, const allocator_type& a)
         : base(a) {
     for (const_iterator i = c.begin(), e = c.end(); i != e; ++i) {
-        push_back(*i);
+        pushBack(*i);
     }
 }
 
 template <typename T, typename Alloc>
 List<T, Alloc>::List(std::initializer_list<value_type> il, const allocator_type& a) : base(a) {
     for (typename std::initializer_list<value_type>::const_iterator i = il.begin(), e = il.end(); i != e; ++i) {
-        push_back(*i);
+        pushBack(*i);
     }
 }
 
 template <typename T, typename Alloc>
 List<T, Alloc>::List(std::initializer_list<value_type> il) {
     for (typename std::initializer_list<value_type>::const_iterator i = il.begin(), e = il.end(); i != e; ++i) {
-        push_back(*i);
+        pushBack(*i);
     }
 }
 
@@ -872,7 +893,7 @@ typename List<T, Alloc>::iterator List<T, Alloc>::insert(const_iterator p, size_
         iterator e = r;
         try {
             for (--n; n != 0; --n, ++e, ++ds) {
-                hold.reset(NodeAllocTraits::allcoate(na, 1));
+                hold.reset(NodeAllocTraits::allocate(na, 1));
                 NodeAllocTraits::construct(na, std::addressof(hold->value), x);
                 e.ptr->next = hold->asLink();
                 hold->prev = e.ptr;
@@ -915,7 +936,7 @@ typename List<T, Alloc>::iterator
         iterator e = r;
         try {
             for (++f; f != l; ++f, (void) ++e, (void) ++ds) {
-                hold.reset(NodeAllocTraits::allcoate(na, 1));
+                hold.reset(NodeAllocTraits::allocate(na, 1));
                 NodeAllocTraits::construct(na, std::addressof(hold->value), *f);
                 e.ptr->next = hold.get()->asLink();
                 hold->prev = e.ptr;
@@ -1034,7 +1055,7 @@ void List<T, Alloc>::popFront() {
     NodeAllocator& na = base::nodeAlloc();
     LinkPointer n = base::end_.next;
     base::unlinkNodes(n, n);
-    base::sz();
+    --base::sz();
     NodePointer np = n->asNode();
     NodeAllocTraits::destroy(na, std::addressof(np->value));
     NodeAllocTraits::deallocate(na, np, 1);
@@ -1046,7 +1067,7 @@ void List<T, Alloc>::popBack() {
     NodeAllocator& na = base::nodeAlloc();
     LinkPointer n = base::end_.prev;
     base::unlinkNodes(n, n);
-    base::sz();
+    --base::sz();
     NodePointer np = n->asNode();
     NodeAllocTraits::destroy(na, std::addressof(np->value));
     NodeAllocTraits::deallocate(na, np, 1);
@@ -1098,7 +1119,7 @@ void List<T, Alloc>::resize(size_type n) {
         iterator e = r;
         try {
             for (--n; n != 0; --n, ++e, ++ds) {
-                hold.reset(NodeAllocTraits::allcoate(na, 1));
+                hold.reset(NodeAllocTraits::allocate(na, 1));
                 NodeAllocTraits::construct(na, std::addressof(hold->value));
                 e.ptr->next = hold.get()->asLink();
                 hold->prev = e.ptr;
@@ -1137,7 +1158,7 @@ void List<T, Alloc>::resize(size_type n, const value_type& x) {
         iterator e = r;
         try {
             for (--n; n != 0; --n, ++e, ++ds) {
-                hold.reset(NodeAllocTraits::allcoate(na, 1));
+                hold.reset(NodeAllocTraits::allocate(na, 1));
                 NodeAllocTraits::construct(na, std::addressof(hold->value), x);
                 e.ptr->next = hold.get()->asLink();
                 hold->prev = e.ptr;
@@ -1196,7 +1217,7 @@ void List<T, Alloc>::splice(const_iterator p, List& c, const_iterator f, const_i
             base::sz() += s;
         }
         base::unlinkNodes(first, last);
-        link_nodes(p.ptr, first, last);
+        linkNodes(p.ptr, first, last);
     }
 }
 
@@ -1321,7 +1342,7 @@ typename List<T, Alloc>::iterator List<T, Alloc>::Sort(iterator f1, iterator e2,
     iterator f2 = e1 = Sort(e1, e2, n - n2, comp);
     if (comp(*f2, *f1)) {
         iterator m2 = std::next(f2);
-        for (; m2 != e2 && _comp(*m2, *f1); ++m2) ;
+        for (; m2 != e2 && comp(*m2, *f1); ++m2) ;
         LinkPointer f = f2.ptr;
         LinkPointer l = m2.ptr->prev;
         r = f2;
@@ -1336,7 +1357,7 @@ typename List<T, Alloc>::iterator List<T, Alloc>::Sort(iterator f1, iterator e2,
     while (f1 != e1 && f2 != e2) {
         if (comp(*f2, *f1)) {
             iterator m2 = std::next(f2);
-            for (; m2 != e2 && _comp(*m2, *f1); ++m2) ;
+            for (; m2 != e2 && comp(*m2, *f1); ++m2) ;
             LinkPointer f = f2.ptr;
             LinkPointer l = m2.ptr->prev;
             if (e1 == f2) {
@@ -1354,6 +1375,32 @@ typename List<T, Alloc>::iterator List<T, Alloc>::Sort(iterator f1, iterator e2,
     return r;
 }
 
+// Gathers the node links into a contiguous array, sorts the array and relinks the nodes in one pass.
+// Nodes are never moved or reallocated; comp must be callable from several threads at once.
+template <typename T, typename Alloc>
+template <typename Comp>
+void List<T, Alloc>::parallelSort(Comp comp, unsigned threads) {
+    if (base::sz() < 2) {
+        return;
+    }
+    std::vector<LinkPointer> links;
+    links.reserve(base::sz());
+    for (LinkPointer p = base::end_.next; p != base::endAsLink(); p = p->next) {
+        links.push_back(p);
+    }
+    ParallelStableSort(links, [&comp](LinkPointer x, LinkPointer y) {
+        return comp(x->asNode()->value, y->asNode()->value);
+    }, threads);
+    LinkPointer prev = base::endAsLink();
+    for (LinkPointer p : links) {
+        prev->next = p;
+        p->prev = prev;
+        prev = p;
+    }
+    prev->next = base::endAsLink();
+    base::end_.prev = prev;
+}
+
 template <typename T, typename Alloc>
 void List<T, Alloc>::reverse() noexcept {
     if (base::sz() > 1) {
@@ -1412,6 +1459,1049 @@ inline void erase(List<T, Allocator>& c, const U& v) {
 }
 
 
-int main() {
+template <typename T, size_t NodeBytes>
+struct UnrolledNodeBase {
+    UnrolledNodeBase* prev;
+    UnrolledNodeBase* next;
+    size_t count;
+
+    UnrolledNodeBase() : prev(this), next(this), count(0) {}
+};
+
+template <typename T, size_t NodeBytes>
+struct UnrolledNode : public UnrolledNodeBase<T, NodeBytes> {
+    using Base = UnrolledNodeBase<T, NodeBytes>;
+    static_assert(NodeBytes > sizeof(Base), "NodeBytes must leave room for elements after the links");
+    static constexpr size_t capacity = std::max<size_t>(4, (NodeBytes - sizeof(Base)) / sizeof(T));
+
+    alignas(T) std::byte storage[capacity * sizeof(T)];
+
+    T* data() noexcept {
+        return std::launder(reinterpret_cast<T*>(storage));
+    }
+};
+
+template <typename T, size_t NodeBytes, typename Alloc> class UnrolledList;
+
+template <typename T, size_t NodeBytes, bool Const> class UnrolledListIterator {
+    using NodeBase = UnrolledNodeBase<T, NodeBytes>;
+    using Node = UnrolledNode<T, NodeBytes>;
+
+    NodeBase* node;
+    size_t idx;
+
+    UnrolledListIterator(NodeBase* n, size_t i) noexcept : node(n), idx(i) {}
+
+    template <typename, size_t, typename> friend class UnrolledList;
+    template <typename, size_t, bool> friend class UnrolledListIterator;
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+    using difference_type = std::ptrdiff_t;
+
+    UnrolledListIterator() noexcept : node(nullptr), idx(0) {}
+
+    template <bool C = Const, std::enable_if_t<C, bool> = true>
+    UnrolledListIterator(const UnrolledListIterator<T, NodeBytes, false>& p) noexcept : node(p.node), idx(p.idx) {}
+
+    reference operator*() const {
+        return static_cast<Node*>(node)->data()[idx];
+    }
+
+    pointer operator->() const {
+        return static_cast<Node*>(node)->data() + idx;
+    }
+
+    UnrolledListIterator& operator++() {
+        if (++idx == node->count) {
+            node = node->next;
+            idx = 0;
+        }
+        return *this;
+    }
+
+    UnrolledListIterator operator++(int) {
+        UnrolledListIterator t(*this);
+        ++(*this);
+        return t;
+    }
+
+    UnrolledListIterator& operator--() {
+        if (idx == 0) {
+            node = node->prev;
+            idx = node->count;
+        }
+        --idx;
+        return *this;
+    }
+
+    UnrolledListIterator operator--(int) {
+        UnrolledListIterator t(*this);
+        --(*this);
+        return t;
+    }
+
+    friend bool operator==(const UnrolledListIterator& x, const UnrolledListIterator& y) {
+        return x.node == y.node && x.idx == y.idx;
+    }
+
+    friend bool operator!=(const UnrolledListIterator& x, const UnrolledListIterator& y) {
+        return !(x == y);
+    }
+};
+
+// A doubly linked list of nodes that each hold up to UnrolledNode::capacity elements in place.
+// Inserting or erasing touches at most the node at the position and one neighbour,
+// so iterators into every other node stay valid; iterators into those one or two nodes are invalidated.
+template <typename T, size_t NodeBytes = 64, typename Alloc = std::allocator<T>>
+class UnrolledList {
+    using NodeBase = UnrolledNodeBase<T, NodeBytes>;
+    using Node = UnrolledNode<T, NodeBytes>;
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using NodeAllocator = typename AllocTraits::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+    using ValueAllocator = typename AllocTraits::template rebind_alloc<T>;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    static_assert(std::is_same_v<value_type, typename allocator_type::value_type>);
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using size_type = typename AllocTraits::size_type;
+    using difference_type = typename AllocTraits::difference_type;
+    using iterator = UnrolledListIterator<T, NodeBytes, false>;
+    using const_iterator = UnrolledListIterator<T, NodeBytes, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type nodeCapacity = Node::capacity;
+
+    UnrolledList() = default;
+    explicit UnrolledList(const allocator_type& a) : sizeAlloc(0, NodeAllocator(a)), valueAlloc(a) {}
+    UnrolledList(std::initializer_list<value_type> il, const allocator_type& a = allocator_type());
+    UnrolledList(const UnrolledList& c);
+    UnrolledList(UnrolledList&& c) noexcept;
+    UnrolledList& operator=(const UnrolledList& c);
+    UnrolledList& operator=(UnrolledList&& c) noexcept(NodeAllocTraits::propagate_on_container_move_assignment::value
+            && std::is_nothrow_move_assignable_v<NodeAllocator>);
+    ~UnrolledList() { clear(); }
+
+    allocator_type getAllocator() const noexcept { return allocator_type(valueAlloc); }
+
+    size_type size() const noexcept { return sizeAlloc.first; }
+    bool empty() const noexcept { return size() == 0; }
+
+    iterator begin() noexcept { return iterator(end_.next, 0); }
+    const_iterator begin() const noexcept { return const_iterator(const_cast<NodeBase*>(end_.next), 0); }
+    iterator end() noexcept { return iterator(&end_, 0); }
+    const_iterator end() const noexcept { return const_iterator(const_cast<NodeBase*>(&end_), 0); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    reference front() {
+        assert(!empty());
+        return *begin();
+    }
+    const_reference front() const {
+        assert(!empty());
+        return *begin();
+    }
+    reference back() {
+        assert(!empty());
+        return *std::prev(end());
+    }
+    const_reference back() const {
+        assert(!empty());
+        return *std::prev(end());
+    }
+
+    void pushFront(const value_type& x) { emplace(begin(), x); }
+    void pushFront(value_type&& x) { emplace(begin(), std::move(x)); }
+    void pushBack(const value_type& x) { emplace(end(), x); }
+    void pushBack(value_type&& x) { emplace(end(), std::move(x)); }
+
+    template <typename... Args>
+    reference emplaceBack(Args&&... args) {
+        return *emplace(end(), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator p, Args&&... args);
+
+    iterator insert(const_iterator p, const value_type& x) { return emplace(p, x); }
+    iterator insert(const_iterator p, value_type&& x) { return emplace(p, std::move(x)); }
+
+    void popFront() { erase(begin()); }
+    void popBack() { erase(std::prev(end())); }
+
+    iterator erase(const_iterator p);
+    iterator erase(const_iterator f, const_iterator l);
+
+    void clear() noexcept;
+
+    void splice(const_iterator p, UnrolledList& c);
+    void splice(const_iterator p, UnrolledList&& c) { splice(p, c); }
+    void splice(const_iterator p, UnrolledList& c, const_iterator i);
+    void splice(const_iterator p, UnrolledList& c, const_iterator f, const_iterator l);
+
+    bool invariants() const;
+
+private:
+    NodeBase end_;
+    std::pair<size_type, NodeAllocator> sizeAlloc;
+    ValueAllocator valueAlloc;
+
+    size_type& sz() noexcept { return sizeAlloc.first; }
+    NodeAllocator& nodeAlloc() noexcept { return sizeAlloc.second; }
+    const NodeAllocator& nodeAlloc() const noexcept { return sizeAlloc.second; }
+
+    void copyAssignAlloc(const UnrolledList& c, std::true_type) {
+        if (nodeAlloc() != c.nodeAlloc()) {
+            clear();
+        }
+        nodeAlloc() = c.nodeAlloc();
+        valueAlloc = c.valueAlloc;
+    }
+
+    void copyAssignAlloc(const UnrolledList&, std::false_type) {}
+
+    void moveAssignAlloc(UnrolledList& c, std::true_type) noexcept(std::is_nothrow_move_assignable_v<NodeAllocator>) {
+        nodeAlloc() = std::move(c.nodeAlloc());
+        valueAlloc = std::move(c.valueAlloc);
+    }
+
+    void moveAssignAlloc(UnrolledList&, std::false_type) noexcept {}
+
+    void moveAssign(UnrolledList& c, std::false_type);
+    void moveAssign(UnrolledList& c, std::true_type) noexcept(std::is_nothrow_move_assignable_v<NodeAllocator>);
+
+    static Node* asNode(NodeBase* n) noexcept { return static_cast<Node*>(n); }
+
+    Node* allocateNodeAfter(NodeBase* n);
+    void freeNode(NodeBase* n) noexcept;
+    Node* split(NodeBase* n, size_t k);
+    Node* splitAt(const_iterator& p, std::initializer_list<const_iterator*> others);
+    void shiftRight(Node* n, size_t idx);
+    void shiftLeft(Node* n, size_t idx);
+    NodeBase* boundaryBefore(const_iterator p);
+};
+
+template <typename T, size_t NodeBytes, typename Alloc>
+UnrolledList<T, NodeBytes, Alloc>::UnrolledList(std::initializer_list<value_type> il, const allocator_type& a)
+: sizeAlloc(0, NodeAllocator(a)), valueAlloc(a) {
+    for (const auto& x : il) {
+        pushBack(x);
+    }
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+UnrolledList<T, NodeBytes, Alloc>::UnrolledList(const UnrolledList& c)
+: sizeAlloc(0, NodeAllocTraits::select_on_container_copy_construction(c.sizeAlloc.second)), valueAlloc(c.valueAlloc) {
+    for (const auto& x : c) {
+        pushBack(x);
+    }
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+UnrolledList<T, NodeBytes, Alloc>::UnrolledList(UnrolledList&& c) noexcept
+: sizeAlloc(0, std::move(c.sizeAlloc.second)), valueAlloc(std::move(c.valueAlloc)) {
+    splice(end(), c);
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+UnrolledList<T, NodeBytes, Alloc>& UnrolledList<T, NodeBytes, Alloc>::operator=(const UnrolledList& c) {
+    if (this != &c) {
+        copyAssignAlloc(c, std::integral_constant<bool, NodeAllocTraits::propagate_on_container_copy_assignment::value>());
+        clear();
+        for (const auto& x : c) {
+            pushBack(x);
+        }
+    }
+    return *this;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+UnrolledList<T, NodeBytes, Alloc>& UnrolledList<T, NodeBytes, Alloc>::operator=(UnrolledList&& c)
+        noexcept(NodeAllocTraits::propagate_on_container_move_assignment::value && std::is_nothrow_move_assignable_v<NodeAllocator>) {
+    if (this != &c) {
+        moveAssign(c, std::integral_constant<bool, NodeAllocTraits::propagate_on_container_move_assignment::value>());
+    }
+    return *this;
+}
+
+// Nodes from an unequal allocator that stays behind cannot be adopted, so the elements are moved one by one.
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::moveAssign(UnrolledList& c, std::false_type) {
+    if (nodeAlloc() != c.nodeAlloc()) {
+        clear();
+        for (auto& x : c) {
+            pushBack(std::move(x));
+        }
+    } else {
+        moveAssign(c, std::true_type());
+    }
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::moveAssign(UnrolledList& c, std::true_type)
+        noexcept(std::is_nothrow_move_assignable_v<NodeAllocator>) {
+    clear();
+    moveAssignAlloc(c, std::integral_constant<bool, NodeAllocTraits::propagate_on_container_move_assignment::value>());
+    splice(end(), c);
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+typename UnrolledList<T, NodeBytes, Alloc>::Node* UnrolledList<T, NodeBytes, Alloc>::allocateNodeAfter(NodeBase* n) {
+    Node* m = std::to_address(NodeAllocTraits::allocate(nodeAlloc(), 1));
+    m->count = 0;
+    m->prev = n;
+    m->next = n->next;
+    n->next->prev = m;
+    n->next = m;
+    return m;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::freeNode(NodeBase* n) noexcept {
+    n->prev->next = n->next;
+    n->next->prev = n->prev;
+    NodeAllocTraits::deallocate(nodeAlloc(), asNode(n), 1);
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+typename UnrolledList<T, NodeBytes, Alloc>::Node* UnrolledList<T, NodeBytes, Alloc>::split(NodeBase* n, size_t k) {
+    Node* m = allocateNodeAfter(n);
+    T* from = asNode(n)->data();
+    T* to = m->data();
+    for (size_t i = k; i < n->count; i++) {
+        AllocTraits::construct(valueAlloc, to + (i - k), std::move(from[i]));
+        AllocTraits::destroy(valueAlloc, from + i);
+    }
+    m->count = n->count - k;
+    n->count = k;
+    return m;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::shiftRight(Node* n, size_t idx) {
+    T* d = n->data();
+    size_t c = n->count;
+    if (idx < c) {
+        AllocTraits::construct(valueAlloc, d + c, std::move(d[c - 1]));
+        std::move_backward(d + idx, d + c - 1, d + c);
+        AllocTraits::destroy(valueAlloc, d + idx);
+    }
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::shiftLeft(Node* n, size_t idx) {
+    T* d = n->data();
+    std::move(d + idx + 1, d + n->count, d + idx);
+    AllocTraits::destroy(valueAlloc, d + n->count - 1);
+    --n->count;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+template <typename... Args>
+typename UnrolledList<T, NodeBytes, Alloc>::iterator UnrolledList<T, NodeBytes, Alloc>::emplace(const_iterator p, Args&&... args) {
+    NodeBase* n = p.node;
+    size_t idx = p.idx;
+    if (idx == 0 && n->prev != &end_ && n->prev->count < nodeCapacity) {
+        n = n->prev;
+        idx = n->count;
+    } else if (n == &end_) {
+        n = allocateNodeAfter(end_.prev);
+    } else if (n->count == nodeCapacity) {
+        Node* m = split(n, nodeCapacity / 2);
+        if (idx > n->count) {
+            idx -= n->count;
+            n = m;
+        }
+    }
+    Node* node = asNode(n);
+    shiftRight(node, idx);
+    try {
+        AllocTraits::construct(valueAlloc, node->data() + idx, std::forward<Args>(args)...);
+    } catch (...) {
+        T* d = node->data();
+        if (idx < node->count) {
+            AllocTraits::construct(valueAlloc, d + idx, std::move(d[idx + 1]));
+            std::move(d + idx + 2, d + node->count + 1, d + idx + 1);
+            AllocTraits::destroy(valueAlloc, d + node->count);
+        } else if (node->count == 0) {
+            freeNode(node);
+        }
+        throw;
+    }
+    ++node->count;
+    ++sz();
+    return iterator(n, idx);
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+typename UnrolledList<T, NodeBytes, Alloc>::iterator UnrolledList<T, NodeBytes, Alloc>::erase(const_iterator p) {
+    assert(p != end());
+    NodeBase* n = p.node;
+    size_t idx = p.idx;
+    shiftLeft(asNode(n), idx);
+    --sz();
+    if (n->count == 0) {
+        NodeBase* next = n->next;
+        freeNode(n);
+        return iterator(next, 0);
+    }
+    NodeBase* next = n->next;
+    if (next != &end_ && n->count < nodeCapacity / 2 && n->count + next->count <= nodeCapacity) {
+        T* d = asNode(n)->data();
+        T* from = asNode(next)->data();
+        for (size_t i = 0; i < next->count; i++) {
+            AllocTraits::construct(valueAlloc, d + n->count + i, std::move(from[i]));
+            AllocTraits::destroy(valueAlloc, from + i);
+        }
+        n->count += next->count;
+        freeNode(next);
+    }
+    return idx < n->count ? iterator(n, idx) : iterator(n->next, 0);
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+typename UnrolledList<T, NodeBytes, Alloc>::iterator UnrolledList<T, NodeBytes, Alloc>::erase(const_iterator f, const_iterator l) {
+    size_type n = std::distance(f, l);
+    iterator r(f.node, f.idx);
+    for (; n > 0; --n) {
+        r = erase(r);
+    }
+    return r;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::clear() noexcept {
+    while (end_.next != &end_) {
+        NodeBase* n = end_.next;
+        T* d = asNode(n)->data();
+        for (size_t i = 0; i < n->count; i++) {
+            AllocTraits::destroy(valueAlloc, d + i);
+        }
+        freeNode(n);
+    }
+    sz() = 0;
+}
+
+// Splits the node under p so that p starts a node, and returns the node that will precede spliced nodes.
+template <typename T, size_t NodeBytes, typename Alloc>
+typename UnrolledList<T, NodeBytes, Alloc>::NodeBase* UnrolledList<T, NodeBytes, Alloc>::boundaryBefore(const_iterator p) {
+    if (p.idx == 0) {
+        return p.node->prev;
+    }
+    split(p.node, p.idx);
+    return p.node;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::splice(const_iterator p, UnrolledList& c) {
+    assert(this != &c);
+    if (c.empty()) {
+        return;
+    }
+    NodeBase* before = boundaryBefore(p);
+    NodeBase* f = c.end_.next;
+    NodeBase* l = c.end_.prev;
+    c.end_.next = c.end_.prev = &c.end_;
+    f->prev = before;
+    l->next = before->next;
+    before->next->prev = l;
+    before->next = f;
+    sz() += c.sz();
+    c.sz() = 0;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::splice(const_iterator p, UnrolledList& c, const_iterator i) {
+    if (p != i) {
+        splice(p, c, i, std::next(i));
+    }
+}
+
+// Splits the node under p so that p starts a node, moving the tail of that node into a new one.
+// Each of others that pointed into the moved tail is updated to its new place.
+template <typename T, size_t NodeBytes, typename Alloc>
+typename UnrolledList<T, NodeBytes, Alloc>::Node* UnrolledList<T, NodeBytes, Alloc>::splitAt(const_iterator& p,
+        std::initializer_list<const_iterator*> others) {
+    NodeBase* n = p.node;
+    size_t k = p.idx;
+    Node* m = split(n, k);
+    for (const_iterator* o : others) {
+        if (o->node == n && o->idx >= k) {
+            *o = const_iterator(m, o->idx - k);
+        }
+    }
+    p = const_iterator(m, 0);
+    return m;
+}
+
+// Splits the nodes under f and l so the range is made of whole nodes, then relinks those nodes after
+// the node boundary at p. Elements in whole nodes keep their addresses; the tails of the nodes under
+// f and p are moved into new nodes, so iterators and references into them are invalidated.
+// As with List, the two lists must use equal allocators.
+template <typename T, size_t NodeBytes, typename Alloc>
+void UnrolledList<T, NodeBytes, Alloc>::splice(const_iterator p, UnrolledList& c, const_iterator f, const_iterator l) {
+    if (f == l || (this == &c && (p == f || p == l))) {
+        return;
+    }
+    if (l.idx != 0) {
+        splitAt(l, {&f, &p});
+    }
+    if (f.idx != 0) {
+        splitAt(f, {&l, &p});
+    }
+    NodeBase* first = f.node;
+    NodeBase* last = l.node->prev;
+    NodeBase* before = p.idx == 0 ? p.node->prev : p.node;
+    if (p.idx != 0) {
+        split(p.node, p.idx);
+    }
+    size_type n = 0;
+    for (NodeBase* i = first; i != l.node; i = i->next) {
+        n += i->count;
+    }
+    first->prev->next = l.node;
+    l.node->prev = first->prev;
+    first->prev = before;
+    last->next = before->next;
+    before->next->prev = last;
+    before->next = first;
+    c.sz() -= n;
+    sz() += n;
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+bool UnrolledList<T, NodeBytes, Alloc>::invariants() const {
+    size_type total = 0;
+    for (const NodeBase* n = end_.next; n != &end_; n = n->next) {
+        if (n->count == 0 || n->count > nodeCapacity || n->next->prev != n) {
+            return false;
+        }
+        total += n->count;
+    }
+    return total == size();
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+inline bool operator==(const UnrolledList<T, NodeBytes, Alloc>& x, const UnrolledList<T, NodeBytes, Alloc>& y) {
+    return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+}
+
+template <typename T, size_t NodeBytes, typename Alloc>
+inline bool operator!=(const UnrolledList<T, NodeBytes, Alloc>& x, const UnrolledList<T, NodeBytes, Alloc>& y) {
+    return !(x == y);
+}
+
+// Embedded in objects that an IntrusiveList links without allocating nodes. A type can derive from
+// several hooks with distinct tags to sit in several lists at once. An unlinked hook points at itself;
+// copying an object does not copy its links.
+template <typename Tag = void>
+struct ListHook : public ListNodeBase<ListHook<Tag>, void*> {
+    ListHook() = default;
+    ListHook(const ListHook&) noexcept {}
+    ListHook& operator=(const ListHook&) noexcept { return *this; }
+
+    bool linked() const noexcept {
+        return this->next != this;
+    }
+};
+
+template <typename T, typename Tag, bool Const> class IntrusiveListIterator {
+    using Hook = ListHook<Tag>;
+    using LinkPointer = typename Hook::LinkPointer;
+
+    LinkPointer ptr;
+
+    explicit IntrusiveListIterator(LinkPointer p) noexcept : ptr(p) {}
+
+    template <typename, typename> friend class IntrusiveList;
+    template <typename, typename, bool> friend class IntrusiveListIterator;
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+    using difference_type = std::ptrdiff_t;
+
+    IntrusiveListIterator() noexcept : ptr(nullptr) {}
+
+    template <bool C = Const, std::enable_if_t<C, bool> = true>
+    IntrusiveListIterator(const IntrusiveListIterator<T, Tag, false>& p) noexcept : ptr(p.ptr) {}
+
+    reference operator*() const {
+        return static_cast<reference>(static_cast<Hook&>(*ptr));
+    }
+
+    pointer operator->() const {
+        return std::addressof(**this);
+    }
+
+    IntrusiveListIterator& operator++() {
+        ptr = ptr->next;
+        return *this;
+    }
+
+    IntrusiveListIterator operator++(int) {
+        IntrusiveListIterator t(*this);
+        ++(*this);
+        return t;
+    }
+
+    IntrusiveListIterator& operator--() {
+        ptr = ptr->prev;
+        return *this;
+    }
+
+    IntrusiveListIterator operator--(int) {
+        IntrusiveListIterator t(*this);
+        --(*this);
+        return t;
+    }
+
+    friend bool operator==(const IntrusiveListIterator& x, const IntrusiveListIterator& y) {
+        return x.ptr == y.ptr;
+    }
+
+    friend bool operator!=(const IntrusiveListIterator& x, const IntrusiveListIterator& y) {
+        return !(x == y);
+    }
+};
+
+// A List over objects that derive from ListHook<Tag>. The list never owns its elements:
+// insert, erase and splice only relink hooks, and erase or clear leave the objects alive and unlinked.
+// An object must stay alive, and must not be linked elsewhere through the same hook, while it is in the list.
+template <typename T, typename Tag = void>
+class IntrusiveList {
+    using Hook = ListHook<Tag>;
+    using NodeBase = ListNodeBase<Hook, void*>;
+    using LinkPointer = typename Hook::LinkPointer;
+    static_assert(std::is_base_of_v<Hook, T>, "IntrusiveList elements must derive from ListHook<Tag>");
+
+public:
+    using value_type = T;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = IntrusiveListIterator<T, Tag, false>;
+    using const_iterator = IntrusiveListIterator<T, Tag, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    IntrusiveList() noexcept = default;
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+    IntrusiveList(IntrusiveList&& c) noexcept { splice(end(), c); }
+    IntrusiveList& operator=(IntrusiveList&& c) noexcept {
+        if (this != &c) {
+            clear();
+            splice(end(), c);
+        }
+        return *this;
+    }
+    ~IntrusiveList() { clear(); }
+
+    size_type size() const noexcept { return sz; }
+    bool empty() const noexcept { return sz == 0; }
+
+    iterator begin() noexcept { return iterator(end_.next); }
+    const_iterator begin() const noexcept { return const_iterator(end_.next); }
+    iterator end() noexcept { return iterator(endAsLink()); }
+    const_iterator end() const noexcept { return const_iterator(const_cast<IntrusiveList*>(this)->endAsLink()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    reference front() {
+        assert(!empty());
+        return *begin();
+    }
+    const_reference front() const {
+        assert(!empty());
+        return *begin();
+    }
+    reference back() {
+        assert(!empty());
+        return *std::prev(end());
+    }
+    const_reference back() const {
+        assert(!empty());
+        return *std::prev(end());
+    }
+
+    // The iterator for an object known to be in this list, for constant time erase or splice.
+    iterator iteratorTo(reference x) noexcept {
+        return iterator(asLink(x));
+    }
+    const_iterator iteratorTo(const_reference x) const noexcept {
+        return const_iterator(asLink(const_cast<reference>(x)));
+    }
+
+    void pushFront(reference x) noexcept { insert(begin(), x); }
+    void pushBack(reference x) noexcept { insert(end(), x); }
+    void popFront() noexcept { erase(begin()); }
+    void popBack() noexcept { erase(std::prev(end())); }
+
+    iterator insert(const_iterator p, reference x) noexcept;
+    iterator erase(const_iterator p) noexcept;
+    iterator erase(const_iterator f, const_iterator l) noexcept;
+    void clear() noexcept { erase(begin(), end()); }
+
+    void splice(const_iterator p, IntrusiveList& c) noexcept;
+    void splice(const_iterator p, IntrusiveList& c, const_iterator i) noexcept;
+    void splice(const_iterator p, IntrusiveList& c, const_iterator f, const_iterator l) noexcept;
+
+private:
+    NodeBase end_;
+    size_type sz = 0;
+
+    LinkPointer endAsLink() noexcept {
+        return end_.self();
+    }
+
+    static LinkPointer asLink(reference x) noexcept {
+        return static_cast<Hook&>(x).self();
+    }
+
+    static void linkNodes(LinkPointer p, LinkPointer f, LinkPointer l) noexcept {
+        p->prev->next = f;
+        f->prev = p->prev;
+        p->prev = l;
+        l->next = p;
+    }
+
+    static void unlinkNodes(LinkPointer f, LinkPointer l) noexcept {
+        f->prev->next = l->next;
+        l->next->prev = f->prev;
+    }
+};
+
+template <typename T, typename Tag>
+typename IntrusiveList<T, Tag>::iterator IntrusiveList<T, Tag>::insert(const_iterator p, reference x) noexcept {
+    LinkPointer n = asLink(x);
+    assert(!static_cast<Hook&>(x).linked());
+    linkNodes(p.ptr, n, n);
+    ++sz;
+    return iterator(n);
+}
+
+template <typename T, typename Tag>
+typename IntrusiveList<T, Tag>::iterator IntrusiveList<T, Tag>::erase(const_iterator p) noexcept {
+    assert(p != end());
+    LinkPointer n = p.ptr;
+    LinkPointer r = n->next;
+    unlinkNodes(n, n);
+    n->prev = n->next = n;
+    --sz;
+    return iterator(r);
+}
+
+template <typename T, typename Tag>
+typename IntrusiveList<T, Tag>::iterator IntrusiveList<T, Tag>::erase(const_iterator f, const_iterator l) noexcept {
+    while (f != l) {
+        f = erase(f);
+    }
+    return iterator(l.ptr);
+}
+
+template <typename T, typename Tag>
+void IntrusiveList<T, Tag>::splice(const_iterator p, IntrusiveList& c) noexcept {
+    if (c.empty()) {
+        return;
+    }
+    LinkPointer f = c.end_.next;
+    LinkPointer l = c.end_.prev;
+    unlinkNodes(f, l);
+    linkNodes(p.ptr, f, l);
+    sz += c.sz;
+    c.sz = 0;
+}
+
+template <typename T, typename Tag>
+void IntrusiveList<T, Tag>::splice(const_iterator p, IntrusiveList& c, const_iterator i) noexcept {
+    if (p.ptr != i.ptr && p.ptr != i.ptr->next) {
+        LinkPointer f = i.ptr;
+        unlinkNodes(f, f);
+        linkNodes(p.ptr, f, f);
+        --c.sz;
+        ++sz;
+    }
+}
+
+template <typename T, typename Tag>
+void IntrusiveList<T, Tag>::splice(const_iterator p, IntrusiveList& c, const_iterator f, const_iterator l) noexcept {
+    if (f == l) {
+        return;
+    }
+    if (this != &c) {
+        size_type s = std::distance(f, l);
+        c.sz -= s;
+        sz += s;
+    }
+    LinkPointer first = f.ptr;
+    LinkPointer last = l.ptr->prev;
+    unlinkNodes(first, last);
+    linkNodes(p.ptr, first, last);
+}
+
+struct LruTag;
+struct DirtyTag;
+
+struct CacheEntry : public ListHook<LruTag>, public ListHook<DirtyTag> {
+    int key = 0;
+    long long value = 0;
+};
+
+template <typename ListType>
+void insertEraseTraverse(const char* name, size_t n) {
+    auto t1 = std::chrono::steady_clock::now();
+    ListType l;
+    for (size_t i = 0; i < n; i++) {
+        l.pushBack(static_cast<int>(i));
+    }
+    for (auto it = l.begin(); it != l.end();) {
+        it = l.erase(it);
+        if (it != l.end()) {
+            ++it;
+        }
+    }
+    for (auto it = l.begin(); it != l.end(); ++it) {
+        it = l.insert(it, 0);
+        ++it;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for (int pass = 0; pass < 10; pass++) {
+        for (int x : l) {
+            sum += x;
+        }
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    std::cout << name << " insert/erase : " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+              << "ms, traverse : " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << "ms (" << sum << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    constexpr size_t N = 2'000'000;
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<int> dis(0, 1'000);
+
+    List<std::pair<int, size_t>> stable;
+    for (size_t i = 0; i < N; i++) {
+        stable.pushBack({dis(gen), i});
+    }
+    const auto* firstNode = &stable.front();
+    stable.parallelSort([](const auto& a, const auto& b) { return a.first < b.first; });
+    assert(std::is_sorted(stable.begin(), stable.end()));
+    assert(std::find_if(stable.begin(), stable.end(), [firstNode](const auto& e) { return &e == firstNode; }) != stable.end());
+
+    List<int> l1;
+    for (size_t i = 0; i < N; i++) {
+        l1.pushBack(dis(gen));
+    }
+    List<int> l2(l1);
+
+    auto t1 = std::chrono::steady_clock::now();
+    l1.sort();
+    auto t2 = std::chrono::steady_clock::now();
+    l2.parallelSort();
+    auto t3 = std::chrono::steady_clock::now();
+    assert(l1 == l2);
+
+    std::cout << "sort : " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << "ms\n";
+    std::cout << "parallelSort : " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << "ms\n";
+
+    {
+        NodePoolAllocator<int> a;
+        NodePoolAllocator<double> b(a);
+        assert(NodePoolAllocator<int>(b) == a && b == a && NodePoolAllocator<int>() != a);
+        auto shared = std::allocate_shared<int>(a, 1);
+        auto big = a.allocate(3);
+        assert(reinterpret_cast<std::uintptr_t>(big) % alignof(int) == 0);
+        a.deallocate(big, 3);
+        assert(*shared == 1);
+    }
+
+    // ProfilingAllocator from 19-8 as List's Alloc: the rebound node allocator keeps the tag,
+    // so every node is counted under the list that owns it.
+    AllocationRegistry::instance().setReportAtExit(false);
+    {
+        List<int, ProfilingAllocator<int>> profiled(ProfilingAllocator<int>("List nodes"));
+        for (int i = 0; i < 1'000; i++) {
+            profiled.pushBack(i);
+        }
+        auto live = AllocationRegistry::instance().stats("List nodes");
+        assert(live.allocations == 1'000 && live.bytesLive == 1'000 * live.bytesAllocated / live.allocations);
+    }
+    auto listNodes = AllocationRegistry::instance().stats("List nodes");
+    assert(listNodes.deallocations == 1'000 && listNodes.bytesLive == 0);
+
+    // Assignment between UnrolledLists with unequal allocators: ProfilingAllocator stays with its list, so the
+    // elements are copied or moved into that list's nodes; NodePoolAllocator moves with the nodes it allocated.
+    {
+        using Tagged = UnrolledList<int, 64, ProfilingAllocator<int>>;
+        Tagged a(ProfilingAllocator<int>("UnrolledList a"));
+        for (int i = 0; i < 1'000; i++) {
+            a.pushBack(i);
+        }
+        Tagged b(ProfilingAllocator<int>("UnrolledList b"));
+        b = a;
+        assert(b == a && std::string_view(b.getAllocator().tag()) == "UnrolledList b");
+        Tagged c(ProfilingAllocator<int>("UnrolledList c"));
+        c = std::move(a);
+        assert(c == b && std::string_view(c.getAllocator().tag()) == "UnrolledList c" && c.invariants());
+
+        using Pooled = UnrolledList<int, 64, NodePoolAllocator<int>>;
+        NodePoolAllocator<int> pool;
+        Pooled p(pool);
+        for (int i = 0; i < 1'000; i++) {
+            p.pushBack(i);
+        }
+        Pooled q {1, 2, 3};
+        q = p;
+        assert(q == p && q.getAllocator() != pool);
+        q = std::move(p);
+        assert(p.empty() && q.getAllocator() == pool && q.invariants() && q.size() == 1'000);
+    }
+    for (const char* tag : {"UnrolledList a", "UnrolledList b", "UnrolledList c"}) {
+        auto stats = AllocationRegistry::instance().stats(tag);
+        assert(stats.allocations == stats.deallocations && stats.bytesLive == 0);
+    }
+
+    insertEraseTraverse<List<int>>("std::allocator", N);
+    insertEraseTraverse<List<int, NodePoolAllocator<int>>>("NodePoolAllocator", N);
+    insertEraseTraverse<List<int, NodePoolAllocator<int, true>>>("thread-local NodePoolAllocator", N);
+
+    List<int> ref;
+    UnrolledList<int> unrolled;
+    for (int i = 0; i < 100'000; i++) {
+        size_t pos = ref.empty() ? 0 : gen() % (ref.size() + 1);
+        auto r = std::next(ref.begin(), pos);
+        auto u = std::next(unrolled.begin(), pos);
+        if (dis(gen) < 600 || ref.empty()) {
+            ref.insert(r, i);
+            unrolled.insert(u, i);
+        } else if (r != ref.end()) {
+            ref.erase(r);
+            unrolled.erase(u);
+        }
+        if (i % 997 == 0) {
+            assert(unrolled.invariants());
+            assert(std::equal(ref.begin(), ref.end(), unrolled.begin(), unrolled.end()));
+        }
+    }
+    UnrolledList<int> other {-1, -2, -3};
+    unrolled.splice(std::next(unrolled.begin(), unrolled.size() / 2), other);
+    unrolled.splice(unrolled.begin(), unrolled, std::prev(unrolled.end()));
+    ref.splice(std::next(ref.begin(), ref.size() / 2), List<int> {-1, -2, -3});
+    ref.splice(ref.begin(), ref, std::prev(ref.end()));
+    assert(other.empty() && unrolled.invariants());
+    assert(std::equal(ref.begin(), ref.end(), unrolled.begin(), unrolled.end()));
+
+    UnrolledList<int> donor;
+    List<int> donorRef;
+    for (int i = 0; i < 1'000; i++) {
+        donor.pushBack(-i);
+        donorRef.pushBack(-i);
+    }
+    const int* kept = &*std::next(donor.begin(), 500);
+    unrolled.splice(std::next(unrolled.begin(), 123), donor, std::next(donor.begin(), 7), std::next(donor.begin(), 993));
+    ref.splice(std::next(ref.begin(), 123), donorRef, std::next(donorRef.begin(), 7), std::next(donorRef.begin(), 993));
+    assert(*kept == -500 && &*std::next(unrolled.begin(), 123 + 493) == kept);
+    for (int i = 0; i < 2'000; i++) {
+        size_t a = gen() % (ref.size() + 1);
+        size_t b = gen() % (ref.size() + 1);
+        size_t at = gen() % (ref.size() + 1);
+        if (a > b) {
+            std::swap(a, b);
+        }
+        if (at >= a && at < b) {
+            continue;
+        }
+        unrolled.splice(std::next(unrolled.begin(), at), unrolled, std::next(unrolled.begin(), a), std::next(unrolled.begin(), b));
+        ref.splice(std::next(ref.begin(), at), ref, std::next(ref.begin(), a), std::next(ref.begin(), b));
+        if (i % 97 == 0) {
+            assert(unrolled.invariants());
+            assert(std::equal(ref.begin(), ref.end(), unrolled.begin(), unrolled.end()));
+        }
+    }
+    assert(donor.invariants() && std::equal(donorRef.begin(), donorRef.end(), donor.begin(), donor.end()));
+
+    insertEraseTraverse<UnrolledList<int>>("UnrolledList<64B nodes>", N);
+    insertEraseTraverse<UnrolledList<int, 256>>("UnrolledList<256B nodes>", N);
+    std::cout << "bytes per element : List " << sizeof(ListNode<int, void*>) << ", UnrolledList<64B nodes> "
+              << static_cast<double>(sizeof(UnrolledNode<int, 64>)) / UnrolledNode<int, 64>::capacity << "\n";
+
+    constexpr size_t Capacity = 1'000;
+    std::vector<CacheEntry> arena(Capacity);
+    IntrusiveList<CacheEntry, LruTag> lru;
+    IntrusiveList<CacheEntry, DirtyTag> dirty;
+    for (size_t i = 0; i < Capacity; i++) {
+        arena[i].key = static_cast<int>(i);
+        lru.pushBack(arena[i]);
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < N; i++) {
+        CacheEntry& e = arena[gen() % Capacity];
+        lru.splice(lru.begin(), lru, lru.iteratorTo(e));
+        e.value++;
+        if (!static_cast<ListHook<DirtyTag>&>(e).linked()) {
+            dirty.pushBack(e);
+        }
+        if (dirty.size() == Capacity / 10) {
+            dirty.clear();
+        }
+    }
+    auto t5 = std::chrono::steady_clock::now();
+    assert(lru.size() == Capacity && dirty.size() < Capacity / 10);
+    CacheEntry& victim = lru.back();
+    lru.popBack();
+    assert(!static_cast<ListHook<LruTag>&>(victim).linked());
+    lru.pushFront(victim);
+    assert(&lru.front() == &victim);
+
+    List<CacheEntry*> wrapped;
+    std::vector<List<CacheEntry*>::iterator> where(Capacity);
+    for (size_t i = 0; i < Capacity; i++) {
+        wrapped.pushBack(&arena[i]);
+        where[i] = std::prev(wrapped.end());
+    }
+    auto t6 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < N; i++) {
+        size_t k = gen() % Capacity;
+        wrapped.erase(where[k]);
+        wrapped.pushFront(&arena[k]);
+        where[k] = wrapped.begin();
+    }
+    auto t7 = std::chrono::steady_clock::now();
+    std::cout << "LRU touch : IntrusiveList " << std::chrono::duration_cast<std::chrono::milliseconds>(t5 - t4).count()
+              << "ms, List<CacheEntry*> erase/pushFront " << std::chrono::duration_cast<std::chrono::milliseconds>(t7 - t6).count() << "ms\n";
+
+    // The sorted-insertion experiment of 20-20, with this file's container as a contender. It takes the
+    // same options as 20-20: --csv or --json, --repetitions=N, --warmup=N, --no-flush, --no-counters.
+    BenchmarkSuite suite(BenchmarkOptions::fromArgs(argc, argv));
+    for (size_t n : {128, 512, 2048}) {
+        addSortedInsert<std::list<int>>(suite, "std::list", n);
+        addSortedInsert<List<int>>(suite, "List", n);
+        addSortedInsert<List<int, NodePoolAllocator<int>>>(suite, "List + NodePoolAllocator", n);
+    }
+    suite.run();
+    suite.write(std::cout);
 
 }
\ No newline at end of file
@@ -1,12 +1,31 @@
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <iostream>
 #include <limits>
+#include <random>
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
 #include <type_traits>
 #include <functional>
 #include <iterator>
 #include <utility>
 #include <initializer_list>
+#include <thread>
+#include <vector>
+
+#include "../19/ProfilingAllocator.h"
+#include "../19/Reclamation.h"
+#include "Benchmark.h"
+#include "NodePool.h"
+#include "ParallelSort.h"
 
 template<typename T, typename Deleter = std::default_delete<T>>
 class UniquePtr {
@@ -19,27 +38,28 @@ public:
 private:
     std::pair<pointer, deleter_type> ptr;
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+public:
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr() noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     constexpr UniquePtr(std::nullptr_t) noexcept : ptr(pointer(), deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_default_constructible_v<Deleter> && !std::is_pointer_v<Deleter>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_default_constructible_v<D> && !std::is_pointer_v<D>, bool> = true>
     explicit UniquePtr(pointer p) noexcept : ptr(p, deleter_type{}) {}
 
-    template<std::enable_if_t<std::is_constructible_v<Deleter, Deleter &>, bool>>
+    template<typename D = Deleter, std::enable_if_t<std::is_constructible_v<D, D &>, bool> = true>
     UniquePtr(pointer p, Deleter &d) noexcept : ptr(p, d) {}
 
-    template<std::enable_if_t<!std::is_reference_v<Deleter> && std::is_constructible_v<Deleter, Deleter &&>, bool>>
+    template<typename D = Deleter, std::enable_if_t<!std::is_reference_v<D> && std::is_constructible_v<D, D &&>, bool> = true>
     UniquePtr(pointer p, Deleter &&d) noexcept : ptr(p, std::move(d)) {}
 
     UniquePtr(UniquePtr &&u) noexcept: ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
             std::enable_if_t<(std::is_reference_v<Deleter> && std::is_same_v<Deleter, Deleter2>)
-                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool>>
+                             || (!std::is_reference_v<Deleter> && std::is_convertible_v<Deleter2, Deleter>), bool> = true>
     UniquePtr(UniquePtr<U, Deleter2> &&u) noexcept : ptr(u.release(), std::forward<Deleter>(u.getDeleter())) {}
 
     UniquePtr &operator=(UniquePtr &&u) noexcept {
@@ -49,8 +69,8 @@ private:
     }
 
     template<typename U, typename Deleter2,
-            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool>,
-            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool>>
+            std::enable_if_t<std::is_convertible_v<U *, pointer> && !std::is_array_v<U>, bool> = true,
+            std::enable_if_t<std::is_assignable_v<Deleter &, Deleter2 &&>, bool> = true>
     UniquePtr &operator=(UniquePtr<U, Deleter2> &&u) noexcept {
         reset(u.release());
         ptr.second = std::forward<Deleter2>(u.getDeleter());
@@ -162,7 +182,7 @@ struct ForwardBeginNode {
 
 template <typename T, typename VoidPtr>
 struct BeginNodeOf {
-    using type = typename ForwardBeginNode<typename std::pointer_traits<VoidPtr>::template rebind<ForwardListNode<T, VoidPtr>>>::type;
+    using type = ForwardBeginNode<typename std::pointer_traits<VoidPtr>::template rebind<ForwardListNode<T, VoidPtr>>>;
 };
 
 template <typename T, typename VoidPtr>
@@ -568,6 +588,10 @@ public:
     template <typename Compare>
     void sort(Compare comp);
 
+    void parallelSort() {parallelSort(std::less<value_type>());}
+    template <typename Compare>
+    void parallelSort(Compare comp, unsigned threads = std::thread::hardware_concurrency());
+
     void reverse() noexcept;
 
 private:
@@ -693,8 +717,8 @@ template <typename T, typename Alloc>
 void ForwardList<T, Alloc>::moveAssign(ForwardList& x, std::true_type) noexcept(std::is_nothrow_move_assignable_v<allocator_type>) {
     clear();
     base::moveAssignAlloc(x);
-    base::beforeBegin()->next = x.beforeBegin()->next;
-    x.beforeBegin()->next = nullptr;
+    base::beforeBegin()->next = x.base::beforeBegin()->next;
+    x.base::beforeBegin()->next = nullptr;
 }
 
 template <typename T, typename Alloc>
@@ -997,8 +1021,8 @@ void ForwardList<T, Alloc>::spliceAfter(const_iterator p, ForwardList& x) {
             }
             lm1.getBegin()->next = p.getBegin()->next;
         }
-        p.getBegin()->next = x.beforeBegin()->next;
-        x.beforeBegin()->next = nullptr;
+        p.getBegin()->next = x.base::beforeBegin()->next;
+        x.base::beforeBegin()->next = nullptr;
     }
 }
 
@@ -1111,8 +1135,8 @@ template<typename T, typename Alloc>
 template<typename Compare>
 void ForwardList<T, Alloc>::merge(ForwardList& x, Compare comp) {
     if (this != &x) {
-        base::beforeBegin()->next = Merge(base::beforeBegin()->next, x.beforeBegin()->next, comp);
-        x.beforeBegin()->next = nullptr;
+        base::beforeBegin()->next = Merge(base::beforeBegin()->next, x.base::beforeBegin()->next, comp);
+        x.base::beforeBegin()->next = nullptr;
     }
 }
 
@@ -1186,6 +1210,28 @@ typename ForwardList<T, Alloc>::NodePointer ForwardList<T, Alloc>::Sort(NodePoin
     return Merge(Sort(f1, sz1, comp), Sort(f2, sz2, comp), comp);
 }
 
+// Gathers the nodes into a contiguous array, sorts the array and relinks the nodes in one pass.
+// Nodes are never moved or reallocated; comp must be callable from several threads at once.
+template<typename T, typename Alloc>
+template<typename Compare>
+void ForwardList<T, Alloc>::parallelSort(Compare comp, unsigned threads) {
+    std::vector<NodePointer> nodes;
+    for (NodePointer p = base::beforeBegin()->next; p != nullptr; p = p->next) {
+        nodes.push_back(p);
+    }
+    if (nodes.size() < 2) {
+        return;
+    }
+    ParallelStableSort(nodes, [&comp](NodePointer x, NodePointer y) {
+        return comp(x->value, y->value);
+    }, threads);
+    base::beforeBegin()->next = nodes.front();
+    for (size_t i = 0; i + 1 < nodes.size(); i++) {
+        nodes[i]->next = nodes[i + 1];
+    }
+    nodes.back()->next = nullptr;
+}
+
 template<typename T, typename Alloc>
 void ForwardList<T, Alloc>::reverse() noexcept {
     NodePointer p = base::beforeBegin()->next;
@@ -1252,6 +1298,444 @@ inline void erase(ForwardList<T, Alloc>& c, const U& v) {
     eraseIf(c, [&](auto& elem) {return elem == v;});
 }
 
-int main() {
+// Shared by ConcurrentForwardList and HarrisList. The low bit of next marks the node as logically deleted.
+template <typename T>
+struct ConcurrentForwardListNode {
+    using value_type = T;
+    std::atomic<std::uintptr_t> next;
+    value_type value;
+
+    template <typename... Args>
+    explicit ConcurrentForwardListNode(Args&&... args) : next(0), value(std::forward<Args>(args)...) {}
+
+    static ConcurrentForwardListNode* asNode(std::uintptr_t p) noexcept {
+        return reinterpret_cast<ConcurrentForwardListNode*>(p & ~std::uintptr_t {1});
+    }
+
+    static std::uintptr_t asLink(const ConcurrentForwardListNode* p) noexcept {
+        return reinterpret_cast<std::uintptr_t>(p);
+    }
+
+    static bool marked(std::uintptr_t p) noexcept {
+        return p & 1;
+    }
+};
+
+// Nodes are retired on one thread and reclaimed on another with a default-constructed allocator,
+// so the allocator has to be stateless.
+template <typename T, typename Alloc>
+struct ConcurrentNodeAllocation {
+    using Node = ConcurrentForwardListNode<T>;
+    using NodeAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAllocator>;
+    static_assert(NodeAllocTraits::is_always_equal::value, "concurrent lists need a stateless allocator");
+
+    template <typename... Args>
+    static Node* create(Args&&... args) {
+        NodeAllocator a;
+        Node* n = std::to_address(NodeAllocTraits::allocate(a, 1));
+        try {
+            NodeAllocTraits::construct(a, n, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeAllocTraits::deallocate(a, n, 1);
+            throw;
+        }
+        return n;
+    }
+
+    static void destroy(Node* n) {
+        NodeAllocator a;
+        NodeAllocTraits::destroy(a, n);
+        NodeAllocTraits::deallocate(a, n, 1);
+    }
+
+    // Deleter for nodes retired to HazardPointers.
+    struct Delete {
+        void operator()(Node* n) const noexcept {
+            destroy(n);
+        }
+    };
+};
+
+// Treiber stack: pushFront and popFront are a single CAS on head.
+// popFront holds the head in a hazard pointer, so a recycled node cannot satisfy a stale CAS.
+template <typename T, typename Alloc = std::allocator<T>>
+class ConcurrentForwardList {
+    using Node = ConcurrentForwardListNode<T>;
+    using Nodes = ConcurrentNodeAllocation<T, Alloc>;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
+    ConcurrentForwardList() = default;
+    ConcurrentForwardList(const ConcurrentForwardList&) = delete;
+    ConcurrentForwardList& operator=(const ConcurrentForwardList&) = delete;
+
+    ~ConcurrentForwardList() {
+        std::uintptr_t p = head.load(std::memory_order_acquire);
+        while (p) {
+            std::uintptr_t next = Node::asNode(p)->next.load(std::memory_order_relaxed);
+            Nodes::destroy(Node::asNode(p));
+            p = next;
+        }
+    }
+
+    bool empty() const noexcept {
+        return head.load(std::memory_order_acquire) == 0;
+    }
+
+    template <typename... Args>
+    void emplaceFront(Args&&... args) {
+        Node* n = Nodes::create(std::forward<Args>(args)...);
+        std::uintptr_t h = head.load(std::memory_order_relaxed);
+        do {
+            n->next.store(h, std::memory_order_relaxed);
+        } while (!head.compare_exchange_weak(h, Node::asLink(n), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void pushFront(const value_type& v) { emplaceFront(v); }
+    void pushFront(value_type&& v) { emplaceFront(std::move(v)); }
+
+    std::optional<value_type> popFront() {
+        std::uintptr_t h;
+        while (true) {
+            h = HazardPointers::protect(0, head);
+            if (h == 0) {
+                HazardPointers::clear();
+                return std::nullopt;
+            }
+            std::uintptr_t next = Node::asNode(h)->next.load(std::memory_order_acquire);
+            if (head.compare_exchange_weak(h, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        HazardPointers::clear();
+        Node* n = Node::asNode(h);
+        std::optional<value_type> v(std::move(n->value));
+        HazardPointers::retire(n, typename Nodes::Delete {});
+        return v;
+    }
+
+private:
+    std::atomic<std::uintptr_t> head {0};
+};
+
+// Ordered set after Harris, with Michael's hazard pointer reclamation.
+// erase first marks the victim's next link, then unlinks it; any traversal that meets a marked node
+// helps unlink it, so a node is retired exactly once, by whoever wins the unlinking CAS.
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T>>
+class HarrisList {
+    using Node = ConcurrentForwardListNode<T>;
+    using Nodes = ConcurrentNodeAllocation<T, Alloc>;
+
+public:
+    using value_type = T;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+
+    explicit HarrisList(const key_compare& comp = key_compare()) : comp(comp) {}
+    HarrisList(const HarrisList&) = delete;
+    HarrisList& operator=(const HarrisList&) = delete;
+
+    ~HarrisList() {
+        std::uintptr_t p = head.load(std::memory_order_acquire);
+        while (p) {
+            std::uintptr_t next = Node::asNode(p)->next.load(std::memory_order_relaxed);
+            Nodes::destroy(Node::asNode(p));
+            p = next;
+        }
+    }
+
+    bool insert(const value_type& v);
+    bool erase(const value_type& v);
+
+    bool contains(const value_type& v) {
+        bool found = find(v).found;
+        HazardPointers::clear();
+        return found;
+    }
+
+    // Walks the list without synchronization; only meaningful while no other thread modifies it.
+    template <typename F>
+    void forEachQuiescent(F f) const {
+        for (std::uintptr_t p = head.load(std::memory_order_acquire); p; p = Node::asNode(p)->next.load(std::memory_order_acquire)) {
+            if (!Node::marked(Node::asNode(p)->next.load(std::memory_order_acquire))) {
+                f(Node::asNode(p)->value);
+            }
+        }
+    }
+
+private:
+    struct Position {
+        std::atomic<std::uintptr_t>* prev;
+        std::uintptr_t curr;
+        bool found;
+    };
+
+    std::atomic<std::uintptr_t> head {0};
+    key_compare comp;
+
+    Position find(const value_type& v);
+};
+
+// Hazard slots : 0 holds next, 1 holds curr and 2 holds the node owning prev.
+// Returns with curr the first unmarked node not less than v, still published in slot 1.
+template <typename T, typename Compare, typename Alloc>
+typename HarrisList<T, Compare, Alloc>::Position HarrisList<T, Compare, Alloc>::find(const value_type& v) {
+retry:
+    std::atomic<std::uintptr_t>* prev = &head;
+    std::uintptr_t curr = HazardPointers::protect(1, *prev);
+    while (true) {
+        if (curr == 0) {
+            return {prev, 0, false};
+        }
+        Node* c = Node::asNode(curr);
+        std::uintptr_t next = HazardPointers::protect(0, c->next);
+        if (prev->load(std::memory_order_acquire) != curr) {
+            goto retry;
+        }
+        if (Node::marked(next)) {
+            std::uintptr_t expected = curr;
+            if (!prev->compare_exchange_strong(expected, next & ~std::uintptr_t {1}, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                goto retry;
+            }
+            HazardPointers::retire(c, typename Nodes::Delete {});
+        } else {
+            if (!comp(c->value, v)) {
+                return {prev, curr, !comp(v, c->value)};
+            }
+            prev = &c->next;
+            HazardPointers::set(2, c);
+        }
+        curr = next & ~std::uintptr_t {1};
+        HazardPointers::set(1, Node::asNode(curr));
+    }
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool HarrisList<T, Compare, Alloc>::insert(const value_type& v) {
+    Node* n = nullptr;
+    while (true) {
+        Position pos = find(v);
+        if (pos.found) {
+            HazardPointers::clear();
+            if (n) {
+                Nodes::destroy(n);
+            }
+            return false;
+        }
+        if (!n) {
+            n = Nodes::create(v);
+        }
+        n->next.store(pos.curr, std::memory_order_relaxed);
+        if (pos.prev->compare_exchange_strong(pos.curr, Node::asLink(n), std::memory_order_release, std::memory_order_relaxed)) {
+            HazardPointers::clear();
+            return true;
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Alloc>
+bool HarrisList<T, Compare, Alloc>::erase(const value_type& v) {
+    while (true) {
+        Position pos = find(v);
+        if (!pos.found) {
+            HazardPointers::clear();
+            return false;
+        }
+        Node* c = Node::asNode(pos.curr);
+        std::uintptr_t next = c->next.load(std::memory_order_acquire);
+        if (Node::marked(next) || !c->next.compare_exchange_strong(next, next | 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            continue;
+        }
+        if (pos.prev->compare_exchange_strong(pos.curr, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            HazardPointers::retire(c, typename Nodes::Delete {});
+        } else {
+            find(v);
+        }
+        HazardPointers::clear();
+        return true;
+    }
+}
+
+template <typename F>
+long long runThreads(unsigned threads, F f) {
+    std::vector<std::thread> pool;
+    auto t1 = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back(f, t);
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+}
+
+template <typename ListType>
+void insertEraseTraverse(const char* name, size_t n) {
+    auto t1 = std::chrono::steady_clock::now();
+    ListType l;
+    for (size_t i = 0; i < n; i++) {
+        l.pushFront(static_cast<int>(i));
+    }
+    for (auto it = l.begin(); it != l.end() && std::next(it) != l.end(); ++it) {
+        l.eraseAfter(it);
+    }
+    for (auto it = l.begin(); it != l.end(); ++it) {
+        it = l.insertAfter(it, 0);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for (int pass = 0; pass < 10; pass++) {
+        for (int x : l) {
+            sum += x;
+        }
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    std::cout << name << " insert/erase : " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count()
+              << "ms, traverse : " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << "ms (" << sum << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    constexpr size_t N = 2'000'000;
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<int> dis(0, 1'000);
+
+    ForwardList<int> l1;
+    for (size_t i = 0; i < N; i++) {
+        l1.pushFront(dis(gen));
+    }
+    ForwardList<int> l2(l1);
+
+    auto t1 = std::chrono::steady_clock::now();
+    l1.sort();
+    auto t2 = std::chrono::steady_clock::now();
+    l2.parallelSort();
+    auto t3 = std::chrono::steady_clock::now();
+    assert(std::equal(l1.begin(), l1.end(), l2.begin(), l2.end()));
+
+    std::cout << "sort : " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << "ms\n";
+    std::cout << "parallelSort : " << std::chrono::duration_cast<std::chrono::milliseconds>(t3 - t2).count() << "ms\n";
+
+    {
+        NodePoolAllocator<int> a;
+        NodePoolAllocator<double> b(a);
+        assert(NodePoolAllocator<int>(b) == a && b == a && NodePoolAllocator<int>() != a);
+        auto shared = std::allocate_shared<int>(a, 1);
+        auto big = a.allocate(3);
+        assert(reinterpret_cast<std::uintptr_t>(big) % alignof(int) == 0);
+        a.deallocate(big, 3);
+        assert(*shared == 1);
+    }
+
+    // ProfilingAllocator from 19-8 as ForwardList's Alloc: the rebound node allocator keeps the tag,
+    // so every node is counted under the list that owns it.
+    AllocationRegistry::instance().setReportAtExit(false);
+    {
+        ForwardList<int, ProfilingAllocator<int>> profiled(ProfilingAllocator<int>("ForwardList nodes"));
+        for (int i = 0; i < 1'000; i++) {
+            profiled.pushFront(i);
+        }
+        auto live = AllocationRegistry::instance().stats("ForwardList nodes");
+        assert(live.allocations == 1'000 && live.bytesLive == 1'000 * live.bytesAllocated / live.allocations);
+    }
+    auto forwardListNodes = AllocationRegistry::instance().stats("ForwardList nodes");
+    assert(forwardListNodes.deallocations == 1'000 && forwardListNodes.bytesLive == 0);
+
+    insertEraseTraverse<ForwardList<int>>("std::allocator", N);
+    insertEraseTraverse<ForwardList<int, NodePoolAllocator<int>>>("NodePoolAllocator", N);
+    insertEraseTraverse<ForwardList<int, NodePoolAllocator<int, true>>>("thread-local NodePoolAllocator", N);
+
+    constexpr unsigned Threads = 4;
+    constexpr int PerThread = 200'000;
+    ConcurrentForwardList<int> stack;
+    std::vector<std::vector<int>> popped(Threads);
+    runThreads(Threads, [&](unsigned t) {
+        for (int i = 0; i < PerThread; i++) {
+            stack.pushFront(static_cast<int>(t) * PerThread + i);
+            if (i % 3 != 0) {
+                if (auto v = stack.popFront()) {
+                    popped[t].push_back(*v);
+                }
+            }
+        }
+    });
+    std::vector<int> seen;
+    for (auto& v : popped) {
+        seen.insert(seen.end(), v.begin(), v.end());
+    }
+    while (auto v = stack.popFront()) {
+        seen.push_back(*v);
+    }
+    std::sort(seen.begin(), seen.end());
+    assert(seen.size() == Threads * PerThread);
+    for (size_t i = 0; i < seen.size(); i++) {
+        assert(seen[i] == static_cast<int>(i));
+    }
+
+    constexpr int Keys = 20'000;
+    HarrisList<int> set;
+    std::atomic<int> inserted {0};
+    std::atomic<int> erased {0};
+    runThreads(Threads, [&](unsigned t) {
+        std::mt19937 g(t);
+        for (int i = 0; i < Keys; i++) {
+            int k = static_cast<int>(g() % Keys);
+            set.contains(k);
+            inserted += set.insert(k);
+            erased += set.erase(static_cast<int>(g() % Keys));
+        }
+    });
+    std::vector<int> remaining;
+    set.forEachQuiescent([&](int k) { remaining.push_back(k); });
+    assert(std::is_sorted(remaining.begin(), remaining.end()));
+    assert(std::adjacent_find(remaining.begin(), remaining.end()) == remaining.end());
+    assert(static_cast<int>(remaining.size()) == inserted - erased);
+    runThreads(Threads, [&](unsigned) {
+        for (int k = 0; k < Keys; k++) {
+            set.erase(k);
+        }
+    });
+    remaining.clear();
+    set.forEachQuiescent([&](int k) { remaining.push_back(k); });
+    assert(remaining.empty());
+
+    constexpr int Ops = 1'000'000;
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        ForwardList<int> locked;
+        std::mutex m;
+        auto lockedMs = runThreads(threads, [&](unsigned) {
+            for (int i = 0; i < Ops / static_cast<int>(threads); i++) {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    locked.pushFront(i);
+                }
+                std::lock_guard<std::mutex> lock(m);
+                locked.popFront();
+            }
+        });
+        ConcurrentForwardList<int, NodePoolAllocator<int, true>> lockFree;
+        auto lockFreeMs = runThreads(threads, [&](unsigned) {
+            for (int i = 0; i < Ops / static_cast<int>(threads); i++) {
+                lockFree.pushFront(i);
+                lockFree.popFront();
+            }
+        });
+        std::cout << threads << " threads, push/pop : mutex ForwardList " << lockedMs
+                  << "ms, ConcurrentForwardList " << lockFreeMs << "ms\n";
+    }
+
+    // The sorted-insertion experiment of 20-20, with this file's container as a contender. It takes the
+    // same options as 20-20: --csv or --json, --repetitions=N, --warmup=N, --no-flush, --no-counters.
+    BenchmarkSuite suite(BenchmarkOptions::fromArgs(argc, argv));
+    for (size_t n : {128, 512, 2048}) {
+        addSortedInsert<std::forward_list<int>>(suite, "std::forward_list", n);
+        addSortedInsert<ForwardList<int>>(suite, "ForwardList", n);
+        addSortedInsert<ForwardList<int, NodePoolAllocator<int>>>(suite, "ForwardList + NodePoolAllocator", n);
+    }
+    suite.run();
+    suite.write(std::cout);
 
 }
\ No newline at end of file
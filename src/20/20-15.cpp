@@ -1,12 +1,25 @@
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <chrono>
 #include <initializer_list>
+#include <iostream>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <numeric>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "../19/HugePageAllocator.h"
+#include "../19/ProfilingAllocator.h"
+#include "Benchmark.h"
 
 template <typename T, typename Allocator>
 class VectorBase {
@@ -147,14 +160,14 @@ public:
         w += n;
         return w;
     }
-    constexpr WrapIter& operator+=(difference_type n) const noexcept {
+    constexpr WrapIter& operator+=(difference_type n) noexcept {
         i += n;
         return *this;
     }
     constexpr WrapIter operator-(difference_type n) const noexcept {
         return *this + (-n);
     }
-    constexpr WrapIter& operator-=(difference_type n) const noexcept {
+    constexpr WrapIter& operator-=(difference_type n) noexcept {
         *this += -n;
         return *this;
     }
@@ -377,7 +390,7 @@ private:
         Alloc() = std::move(c.Alloc());
     }
 
-    void MoveAssignAlloc(SplitBuffer& c, std::false_type) noexcept {}
+    void MoveAssignAlloc(SplitBuffer&, std::false_type) noexcept {}
 
     struct ConstructTransaction {
         explicit ConstructTransaction(pointer* p, size_type n) noexcept : pos_(*p), end_(*p + n), dest_(p) {}
@@ -974,7 +987,7 @@ private:
     template <typename... Args>
     void ConstructOneAtEnd(Args&&... args) {
         ConstructTransaction tx (*this, 1);
-        AllocTraits::construct(this->Alloc(), std::to_address(tx.pos_), std::forward<Args>(args)...);
+        AllocTraits::construct(this->alloc(), std::to_address(tx.pos_), std::forward<Args>(args)...);
         ++tx.pos_;
     }
 };
@@ -992,10 +1005,13 @@ Vector(InputIterator, InputIterator, Alloc) -> Vector<typename std::iterator_tra
 template <typename T, typename Allocator>
 void Vector<T, Allocator>::SwapOutCircularBuffer(SplitBuffer<value_type, allocator_type&>& v) {
     AnnotateDelete();
-    AllocTraits::construct_backward_with_exception_guarantees(this->Alloc(), this->begin_, this->end_, v.begin_);
+    for (pointer e = this->end_; e != this->begin_;) {
+        AllocTraits::construct(this->alloc(), std::to_address(v.begin_ - 1), std::move_if_noexcept(*--e));
+        --v.begin_;
+    }
     std::swap(this->begin_, v.begin_);
     std::swap(this->end_, v.end_);
-    std::swap(this->EndCap(), v.EndCap());
+    std::swap(this->endCap(), v.EndCap());
     v.first_ = v.begin_;
     AnnotateNew(size());
     InvalidateAllIterators();
@@ -1005,27 +1021,17 @@ template <typename T, typename Allocator>
 typename Vector<T, Allocator>::pointer Vector<T, Allocator>::SwapOutCircularBuffer(SplitBuffer<value_type, allocator_type&>& v, pointer p) {
     AnnotateDelete();
     pointer r = v.begin_;
-    static_assert(std::integral_constant<bool,
-            std::is_same_v<decltype(std::declval<Allocator>.construct(std::declval<typename Allocator::value_type*>(),
-                    std::declval<typename Allocator::value_type&&>())), std::true_type>>::value && !std::allocator<Allocator>::value
-                    || std::is_move_constructible_v<typename Allocator::value_type>);
-    pointer b1 = this->begin_;
-    pointer e1 = p;
-    pointer e2 = v.begin_;
-    while (e1 != b1) {
-        AllocTraits::construct(this->Alloc(), std::to_address(e2 - 1), std::move_if_noexcept(*--e1));
-        --e2;
-    }
-    b1 = p;
-    e1 = this->end_;
-    e2 = v.end_;
-    while (e1 != b1) {
-        AllocTraits::construct(this->Alloc(), std::to_address(e2 - 1), std::move_if_noexcept(*--e1));
-        --e2;
+    for (pointer e = p; e != this->begin_;) {
+        AllocTraits::construct(this->alloc(), std::to_address(v.begin_ - 1), std::move_if_noexcept(*--e));
+        --v.begin_;
+    }
+    for (pointer b = p; b != this->end_; ++b) {
+        AllocTraits::construct(this->alloc(), std::to_address(v.end_), std::move_if_noexcept(*b));
+        ++v.end_;
     }
     std::swap(this->begin_, v.begin_);
     std::swap(this->end_, v.end_);
-    std::swap(this->EndCap(), v.EndCap());
+    std::swap(this->endCap(), v.EndCap());
     v.first_ = v.begin_;
     AnnotateNew(size());
     InvalidateAllIterators();
@@ -1037,8 +1043,8 @@ void Vector<T, Allocator>::Vallocate(size_type n) {
     if (n > maxSize()) {
         throw std::length_error("");
     }
-    this->begin_ = this->end_ = AllocTraits(this->Alloc(), n);
-    this->EndCap() = this->begin_ + n;
+    this->begin_ = this->end_ = AllocTraits::allocate(this->alloc(), n);
+    this->endCap() = this->begin_ + n;
     AnnotateNew(0);
 }
 
@@ -1046,14 +1052,14 @@ template <typename T, typename Allocator>
 void Vector<T, Allocator>::Vdeallocate() noexcept {
     if (this->begin_ != nullptr) {
         clear();
-        AllocTraits::deallocate(this->Alloc(), this->begin_, capacity());
-        this->begin_ = this->end_ = this->EndCap() = nullptr;
+        AllocTraits::deallocate(this->alloc(), this->begin_, capacity());
+        this->begin_ = this->end_ = this->endCap() = nullptr;
     }
 }
 
 template <typename T, typename Allocator>
 typename Vector<T, Allocator>::size_type Vector<T, Allocator>::maxSize() const noexcept {
-    return std::min<size_type>(AllocTraits::maxSize(this->Alloc()), std::numeric_limits<difference_type>::max());
+    return std::min<size_type>(AllocTraits::max_size(this->alloc()), std::numeric_limits<difference_type>::max());
 }
 
 template <typename T, typename Allocator>
@@ -1073,7 +1079,7 @@ template <typename T, typename Allocator>
 void Vector<T, Allocator>::ConstructAtEnd(size_type n) {
     ConstructTransaction tx (*this, n);
     for (; tx.pos_ != tx.new_end_; ++tx.pos_) {
-        AllocTraits::construct(this->Alloc(), std::to_address(tx.pos_));
+        AllocTraits::construct(this->alloc(), std::to_address(tx.pos_));
     }
 }
 
@@ -1081,7 +1087,7 @@ template <typename T, typename Allocator>
 void Vector<T, Allocator>::ConstructAtEnd(size_type n, const_reference x) {
     ConstructTransaction tx (*this, n);
     for (; tx.pos_ != tx.new_end_; ++tx.pos_) {
-        AllocTraits::construct(this->Alloc(), std::to_address(tx.pos_), x);
+        AllocTraits::construct(this->alloc(), std::to_address(tx.pos_), x);
     }
 }
 
@@ -1092,16 +1098,16 @@ typename std::enable_if_t<std::integral_constant<bool,
         void> Vector<T, Allocator>::ConstructAtEnd(ForwardIterator first, ForwardIterator last, size_type n) {
     ConstructTransaction tx (*this, n);
     for (; first != last; ++first, (void) ++tx.pos_) {
-        AllocTraits::construct(this->Alloc(), std::to_address(n), *first);
+        AllocTraits::construct(this->alloc(), std::to_address(tx.pos_), *first);
     }
 }
 
 template <typename T, typename Allocator>
 void Vector<T, Allocator>::Append(size_type n) {
-    if (static_cast<size_type>(this->EndCap() - this->end_) >= n) {
+    if (static_cast<size_type>(this->endCap() - this->end_) >= n) {
         this->ConstructAtEnd(n);
     } else {
-        allocator_type& a = this->Alloc();
+        allocator_type& a = this->alloc();
         SplitBuffer<value_type, allocator_type&> v(Recommend(size() + n), size(), a);
         v.ConstructAtEnd(n);
         SwapOutCircularBuffer(v);
@@ -1110,10 +1116,10 @@ void Vector<T, Allocator>::Append(size_type n) {
 
 template <typename T, typename Allocator>
 void Vector<T, Allocator>::Append(size_type n, const_reference x) {
-    if (static_cast<size_type>(this->EndCap() - this->end_) >= n) {
+    if (static_cast<size_type>(this->endCap() - this->end_) >= n) {
         this->ConstructAtEnd(n, x);
     } else {
-        allocator_type& a = this->Alloc();
+        allocator_type& a = this->alloc();
         SplitBuffer<value_type, allocator_type&> v(Recommend(size() + n), size(), a);
         v.ConstructAtEnd(n, x);
         SwapOutCircularBuffer(v);
@@ -1213,7 +1219,7 @@ typename std::enable_if_t<std::integral_constant<bool,
 }
 
 template <typename T, typename Allocator>
-Vector<T, Allocator>::Vector(const Vector& x) : Base(AllocTraits::select_on_container_copy_construction(x.Alloc())) {
+Vector<T, Allocator>::Vector(const Vector& x) : Base(AllocTraits::select_on_container_copy_construction(x.alloc())) {
     size_type n = x.size();
     if (n > 0) {
         Vallocate(n);
@@ -1231,20 +1237,20 @@ Vector<T, Allocator>::Vector(const Vector& x, const allocator_type& a) : Base(a)
 }
 
 template <typename T, typename Allocator>
-inline Vector<T, Allocator>::Vector(Vector&& x) noexcept : Base(std::move(x.Alloc())) {
+inline Vector<T, Allocator>::Vector(Vector&& x) noexcept : Base(std::move(x.alloc())) {
     this->begin_ = x.begin_;
     this->end_ = x.end_;
-    this->EndCap() = x.EndCap();
-    x.begin_ = x.end_ = x.EndCap() = nullptr;
+    this->endCap() = x.endCap();
+    x.begin_ = x.end_ = x.endCap() = nullptr;
 }
 
 template <typename T, typename Allocator>
 inline Vector<T, Allocator>::Vector(Vector&& x, const allocator_type& a) : Base(a) {
-    if (a == x.Alloc()) {
+    if (a == x.alloc()) {
         this->begin_ = x.begin_;
         this->end_ = x.end_;
-        this->EndCap() = x.EndCap();
-        x.begin_ = x.end_ = x.EndCap() = nullptr;
+        this->endCap() = x.endCap();
+        x.begin_ = x.end_ = x.endCap() = nullptr;
     } else {
         assign(std::move_iterator<iterator>(x.begin()), std::move_iterator<iterator>(x.end()));
     }
@@ -1276,7 +1282,7 @@ inline Vector<T, Allocator>& Vector<T, Allocator>::operator=(Vector&& x) noexcep
 
 template <typename T, typename Allocator>
 void Vector<T, Allocator>::MoveAssign(Vector& c, std::false_type) noexcept(AllocTraits::is_always_equal::value) {
-    if (Base::Alloc() != c.Alloc()) {
+    if (Base::alloc() != c.alloc()) {
         assign(std::move_iterator<iterator>(c.begin()), std::move_iterator<iterator>(c.end()));
     } else {
         MoveAssign(c, std::true_type());
@@ -1289,8 +1295,8 @@ void Vector<T, Allocator>::MoveAssign(Vector& c, std::true_type) noexcept(std::i
     Base::MoveAssignAlloc(c);
     this->begin_ = c.begin_;
     this->end_ = c.end_;
-    this->EndCap() = c.EndCap();
-    c.begin_ = c.end_ = c.EndCap() = nullptr;
+    this->endCap() = c.endCap();
+    c.begin_ = c.end_ = c.endCap() = nullptr;
 }
 
 template <typename T, typename Allocator>
@@ -1426,7 +1432,7 @@ typename Vector<T, Allocator>::const_reference Vector<T, Allocator>::at(size_typ
 template <typename T, typename Allocator>
 void Vector<T, Allocator>::reserve(size_type n) {
     if (n > capacity()) {
-        allocator_type& a = this->Alloc();
+        allocator_type& a = this->alloc();
         SplitBuffer<value_type, allocator_type&> v(n, size(), a);
         SwapOutCircularBuffer(v);
     }
@@ -1436,7 +1442,7 @@ template <typename T, typename Allocator>
 void Vector<T, Allocator>::shrinkToFit() noexcept {
     if (capacity() > size()) {
         try {
-            allocator_type &a = this->Alloc();
+            allocator_type &a = this->alloc();
             SplitBuffer<value_type, allocator_type &> v(size(), size(), a);
             SwapOutCircularBuffer(v);
         } catch (...) {
@@ -1447,7 +1453,7 @@ void Vector<T, Allocator>::shrinkToFit() noexcept {
 template <typename T, typename Allocator>
 template <typename U>
 void Vector<T, Allocator>::PushBackSlowPath(U&& x) {
-    allocator_type &a = this->Alloc();
+    allocator_type &a = this->alloc();
     SplitBuffer<value_type, allocator_type &> v(Recommend(size() + 1), size(), a);
     AllocTraits::construct(a, std::to_address(v.end_), std::forward<U>(x));
     v.end_++;
@@ -1456,7 +1462,7 @@ void Vector<T, Allocator>::PushBackSlowPath(U&& x) {
 
 template <typename T, typename Allocator>
 inline void Vector<T, Allocator>::pushBack(const_reference x) {
-    if (this->end_ != this->EndCap()) {
+    if (this->end_ != this->endCap()) {
         ConstructOneAtEnd(x);
     } else {
         PushBackSlowPath(x);
@@ -1465,7 +1471,7 @@ inline void Vector<T, Allocator>::pushBack(const_reference x) {
 
 template <typename T, typename Allocator>
 inline void Vector<T, Allocator>::pushBack(value_type&& x) {
-    if (this->end_ != this->EndCap()) {
+    if (this->end_ != this->endCap()) {
         ConstructOneAtEnd(std::move(x));
     } else {
         PushBackSlowPath(std::move(x));
@@ -1475,7 +1481,7 @@ inline void Vector<T, Allocator>::pushBack(value_type&& x) {
 template <typename T, typename Allocator>
 template <typename... Args>
 void Vector<T, Allocator>::EmplaceBackSlowPath(Args&&... args) {
-    allocator_type &a = this->Alloc();
+    allocator_type &a = this->alloc();
     SplitBuffer<value_type, allocator_type &> v(Recommend(size() + 1), size(), a);
     AllocTraits::construct(a, std::to_address(v.end_), std::forward<Args>(args)...);
     v.end_++;
@@ -1485,7 +1491,7 @@ void Vector<T, Allocator>::EmplaceBackSlowPath(Args&&... args) {
 template <typename T, typename Allocator>
 template <typename... Args>
 inline typename Vector<T, Allocator>::reference Vector<T, Allocator>::emplaceBack(Args&&... args) {
-    if (this->end_ != this->EndCap()) {
+    if (this->end_ != this->endCap()) {
         ConstructOneAtEnd(std::forward<Args>(args)...);
     } else {
         EmplaceBackSlowPath(std::forward<Args>(args)...);
@@ -1530,7 +1536,7 @@ void Vector<T, Allocator>::MoveRange(pointer fromS, pointer fromE, pointer to) {
         pointer i = fromS + n;
         ConstructTransaction tx(*this, fromE - i);
         for (; i < fromE; ++i, ++tx.pos_) {
-            AllocTraits::construct(this->Alloc(), std::to_address(tx.pos_), std::move(*i));
+            AllocTraits::construct(this->alloc(), std::to_address(tx.pos_), std::move(*i));
         }
     }
     std::move_backward(fromS, fromS + n, oldLast);
@@ -1539,19 +1545,16 @@ void Vector<T, Allocator>::MoveRange(pointer fromS, pointer fromE, pointer to) {
 template <typename T, typename Allocator>
 typename Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_iterator position, const_reference x) {
     pointer p = this->begin_ + (position - begin());
-    if (this->end_ < this->EndCap()) {
+    if (this->end_ < this->endCap()) {
         if (p == this->end_) {
             ConstructOneAtEnd(x);
         } else {
+            value_type t(x);
             MoveRange(p, this->end_, p + 1);
-            const_pointer xr = std::pointer_traits<const_pointer>::pointer_to(x);
-            if (p <= xr && xr < this->end) {
-                ++xr;
-            }
-            *p = *xr;
+            *p = std::move(t);
         }
     } else {
-        allocator_type& a = this->Alloc();
+        allocator_type& a = this->alloc();
         SplitBuffer<value_type, allocator_type&> v(Recommend(size() + 1), p - this->begin_, a);
         v.pushBack(x);
         p = SwapOutCircularBuffer(v, p);
@@ -1562,7 +1565,7 @@ typename Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_itera
 template <typename T, typename Allocator>
 typename Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_iterator position, value_type&& x) {
     pointer p = this->begin_ + (position - begin());
-    if (this->end_ < this->EndCap()) {
+    if (this->end_ < this->endCap()) {
         if (p == this->end_) {
             ConstructOneAtEnd(std::move(x));
         } else {
@@ -1570,7 +1573,7 @@ typename Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_itera
             *p = std::move(x);
         }
     } else {
-        allocator_type& a = this->Alloc();
+        allocator_type& a = this->alloc();
         SplitBuffer<value_type, allocator_type&> v(Recommend(size() + 1), p - this->begin_, a);
         v.pushBack(std::move(x));
         p = SwapOutCircularBuffer(v, p);
@@ -1582,17 +1585,17 @@ template <typename T, typename Allocator>
 template <typename... Args>
 typename Vector<T, Allocator>::iterator Vector<T, Allocator>::emplace(const_iterator position, Args&&... args) {
     pointer p = this->begin_ + (position - begin());
-    if (this->end_ < this->EndCap()) {
+    if (this->end_ < this->endCap()) {
         if (p == this->end_) {
             ConstructOneAtEnd(std::forward<Args>(args)...);
         } else {
             typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type v;
-            AllocTraits::construct(this->Alloc(), reinterpret_cast<value_type *>(std::addressof(v)), std::forward<Args>(args)...);
+            AllocTraits::construct(this->alloc(), reinterpret_cast<value_type *>(std::addressof(v)), std::forward<Args>(args)...);
             MoveRange(p, this->end_, p + 1);
             *p = std::move(v);
         }
     } else {
-        allocator_type& a = this->Alloc();
+        allocator_type& a = this->alloc();
         SplitBuffer<value_type, allocator_type&> v(Recommend(size() + 1), p - this->begin_, a);
         v.emplaceBack(std::forward<Args>(args)...);
         p = SwapOutCircularBuffer(v, p);
@@ -1604,7 +1607,7 @@ template <typename T, typename Allocator>
 typename Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_iterator position, size_type n, const_reference x) {
     pointer p = this->begin_ + (position - begin());
     if (n > 0) {
-        if (n <= static_cast<size_type>(this->EndCap() - this->end_)) {
+        if (n <= static_cast<size_type>(this->endCap() - this->end_)) {
             size_type oldN = n;
             pointer oldLast = this->end_;
             if (n > static_cast<size_type>(this->end_ - p)) {
@@ -1621,7 +1624,7 @@ typename Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_itera
                 std::fill_n(p, n, *xr);
             }
         } else {
-            allocator_type& a = this->Alloc();
+            allocator_type& a = this->alloc();
             SplitBuffer<value_type, allocator_type&> v(Recommend(size() + n), p - this->begin_, a);
             v.ConstructAtEnd(n, x);
             p = SwapOutCircularBuffer(v, p);
@@ -1642,9 +1645,9 @@ typename std::enable_if_t<std::integral_constant<bool,
 Vector<T, Allocator>::insert(const_iterator position, InputIterator first, InputIterator last) {
     difference_type off = position - begin();
     pointer p = this->begin_ + off;
-    allocator_type& a = this->Alloc();
+    allocator_type& a = this->alloc();
     pointer oldLast = this->end_;
-    for (; this->end_ != this->EndCap() && first != last; ++first) {
+    for (; this->end_ != this->endCap() && first != last; ++first) {
         ConstructAtEnd(*first);
     }
     SplitBuffer<value_type, allocator_type&> v(a);
@@ -1677,7 +1680,7 @@ Vector<T, Allocator>::insert(const_iterator position, ForwardIterator first, For
     pointer p = this->begin_ + (position - begin());
     difference_type n = std::distance(first, last);
     if (n > 0) {
-        if (n <= this->EndCap() - this->end_) {
+        if (n <= this->endCap() - this->end_) {
             size_type oldN = n;
             pointer oldLast = this->end_;
             ForwardIterator m = last;
@@ -1694,7 +1697,7 @@ Vector<T, Allocator>::insert(const_iterator position, ForwardIterator first, For
                 std::copy(first, m, p);
             }
         } else {
-            allocator_type& a = this->Alloc();
+            allocator_type& a = this->alloc();
             SplitBuffer<value_type, allocator_type&> v(Recommend(size() + n), p - this->begin_, a);
             v.ConstructAtEnd(first, last);
             p = SwapOutCircularBuffer(v, p);
@@ -1726,17 +1729,17 @@ void Vector<T, Allocator>::resize(size_type sz, const_reference x) {
 template <typename T, typename Allocator>
 bool Vector<T, Allocator>::Invariants() const {
     if (this->begin_ == nullptr) {
-        if (this->end_ != nullptr || this->EndCap() != nullptr) {
+        if (this->end_ != nullptr || this->endCap() != nullptr) {
             return false;
         }
     } else {
         if (this->begin_ > this->end_) {
             return false;
         }
-        if (this->begin_ == this->EndCap()) {
+        if (this->begin_ == this->endCap()) {
             return false;
         }
-        if (this->end_ > this->EndCap()) {
+        if (this->end_ > this->endCap()) {
             return false;
         }
     }
@@ -1751,6 +1754,684 @@ inline void Vector<T, Allocator>::InvalidateIteratorsPast(pointer newLast) {
 }
 
 
-int main() {
+template <typename T>
+struct SegmentedVectorChunkSize {
+    static constexpr size_t value = sizeof(T) < 256 ? std::bit_floor(4096 / sizeof(T)) : 16;
+};
+
+template <typename T, typename Allocator>
+class SegmentedVectorBase {
+public:
+    using allocator_type = Allocator;
+    using AllocTraits = std::allocator_traits<allocator_type>;
+    using size_type = typename AllocTraits::size_type;
+protected:
+    using value_type = T;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using difference_type = typename AllocTraits::difference_type;
+    using pointer = typename AllocTraits::pointer;
+    using const_pointer = typename AllocTraits::const_pointer;
+    using PointerAllocator = typename AllocTraits::template rebind_alloc<pointer>;
+    using MapBuffer = SplitBuffer<pointer, PointerAllocator>;
+
+    static constexpr size_type chunkSize = SegmentedVectorChunkSize<value_type>::value;
+    static constexpr size_type chunkShift = std::countr_zero(chunkSize);
+    static constexpr size_type chunkMask = chunkSize - 1;
+    static_assert(std::has_single_bit(chunkSize));
+
+    MapBuffer map_;
+    std::pair<size_type, allocator_type> size_alloc_;
+
+    size_type& sz() noexcept { return size_alloc_.first; }
+    const size_type& sz() const noexcept { return size_alloc_.first; }
+    allocator_type& alloc() noexcept { return size_alloc_.second; }
+    const allocator_type& alloc() const noexcept { return size_alloc_.second; }
+
+    SegmentedVectorBase() noexcept(std::is_nothrow_default_constructible_v<allocator_type>);
+    explicit SegmentedVectorBase(const allocator_type& a);
+    SegmentedVectorBase(SegmentedVectorBase&& c) noexcept;
+    ~SegmentedVectorBase();
+
+    size_type capacity() const noexcept { return map_.size() * chunkSize; }
+
+    pointer slot(size_type n) const noexcept {
+        return map_.begin_[n >> chunkShift] + (n & chunkMask);
+    }
+
+    void clear() noexcept { destructAtEnd(0); }
+    void destructAtEnd(size_type newSize) noexcept;
+    void addChunk();
+    void releaseSpareChunks() noexcept;
+
+    void copyAssignAlloc(const SegmentedVectorBase& c) {
+        copyAssignAlloc(c, std::integral_constant<bool, AllocTraits::propagate_on_container_copy_assignment::value>());
+    }
+
+    void moveAssignAlloc(SegmentedVectorBase& c) noexcept(!AllocTraits::propagate_on_container_move_assignment::value ||
+    std::is_nothrow_move_assignable_v<allocator_type>) {
+        moveAssignAlloc(c, std::integral_constant<bool, AllocTraits::propagate_on_container_move_assignment::value>());
+    }
+
+    void swapAlloc(SegmentedVectorBase& c) noexcept {
+        swapAlloc(c, std::integral_constant<bool, AllocTraits::propagate_on_container_swap::value>());
+    }
+
+private:
+    // The chunks and the map were allocated by the old allocator, so they are returned to it before it is replaced.
+    void copyAssignAlloc(const SegmentedVectorBase& c, std::true_type) {
+        if (alloc() != c.alloc()) {
+            clear();
+            releaseSpareChunks();
+            map_.shrinkToFit();
+        }
+        alloc() = c.alloc();
+        map_.Alloc() = PointerAllocator(c.alloc());
+    }
+
+    void copyAssignAlloc(const SegmentedVectorBase&, std::false_type) {}
+
+    void moveAssignAlloc(SegmentedVectorBase& c, std::true_type) noexcept (std::is_nothrow_move_assignable_v<allocator_type>) {
+        alloc() = std::move(c.alloc());
+    }
+
+    void moveAssignAlloc(SegmentedVectorBase&, std::false_type) {}
+
+    void swapAlloc(SegmentedVectorBase& c, std::true_type) noexcept {
+        std::swap(alloc(), c.alloc());
+        std::swap(map_.Alloc(), c.map_.Alloc());
+    }
+
+    void swapAlloc(SegmentedVectorBase&, std::false_type) noexcept {}
+};
+
+template <typename T, typename Allocator>
+inline SegmentedVectorBase<T, Allocator>::SegmentedVectorBase() noexcept(std::is_nothrow_default_constructible_v<allocator_type>)
+: map_(PointerAllocator()), size_alloc_(0, Allocator()) {
+}
+
+template <typename T, typename Allocator>
+inline SegmentedVectorBase<T, Allocator>::SegmentedVectorBase(const allocator_type& a)
+: map_(PointerAllocator(a)), size_alloc_(0, a) {
+}
+
+template <typename T, typename Allocator>
+inline SegmentedVectorBase<T, Allocator>::SegmentedVectorBase(SegmentedVectorBase&& c) noexcept
+: map_(std::move(c.map_)), size_alloc_(std::move(c.size_alloc_)) {
+    c.sz() = 0;
+}
+
+template <typename T, typename Allocator>
+SegmentedVectorBase<T, Allocator>::~SegmentedVectorBase() {
+    clear();
+    releaseSpareChunks();
+}
+
+template <typename T, typename Allocator>
+void SegmentedVectorBase<T, Allocator>::destructAtEnd(size_type newSize) noexcept {
+    while (sz() != newSize) {
+        AllocTraits::destroy(alloc(), std::to_address(slot(--sz())));
+    }
+}
+
+template <typename T, typename Allocator>
+void SegmentedVectorBase<T, Allocator>::addChunk() {
+    pointer chunk = AllocTraits::allocate(alloc(), chunkSize);
+    try {
+        map_.pushBack(chunk);
+    } catch (...) {
+        AllocTraits::deallocate(alloc(), chunk, chunkSize);
+        throw;
+    }
+}
+
+template <typename T, typename Allocator>
+void SegmentedVectorBase<T, Allocator>::releaseSpareChunks() noexcept {
+    size_type used = (sz() + chunkMask) >> chunkShift;
+    while (map_.size() > used) {
+        AllocTraits::deallocate(alloc(), map_.back(), chunkSize);
+        map_.popBack();
+    }
+}
+
+template <typename T, typename Pointer, typename MapPointer>
+class SegmentedIter {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Pointer;
+    using reference = decltype(*std::declval<Pointer>());
+private:
+    static constexpr size_t chunkShift = std::countr_zero(SegmentedVectorChunkSize<T>::value);
+    static constexpr size_t chunkMask = SegmentedVectorChunkSize<T>::value - 1;
+
+    MapPointer map_;
+    size_t i;
+
+    constexpr SegmentedIter(MapPointer m, size_t n) noexcept : map_(m), i(n) {}
+
+    template <typename, typename, typename> friend class SegmentedIter;
+    template <typename, typename> friend class SegmentedVector;
+public:
+    constexpr SegmentedIter() noexcept : map_ {}, i {0} {}
+
+    template <typename P, typename M>
+    SegmentedIter(const SegmentedIter<T, P, M>& u,
+                  typename std::enable_if_t<std::is_convertible_v<P, pointer>>* = 0) noexcept
+    : map_(u.map_), i(u.i) {}
+
+    reference operator*() const noexcept { return map_[i >> chunkShift][i & chunkMask]; }
+    pointer operator->() const noexcept { return map_[i >> chunkShift] + (i & chunkMask); }
+    reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+    SegmentedIter& operator++() noexcept {
+        ++i;
+        return *this;
+    }
+    SegmentedIter operator++(int) noexcept {
+        SegmentedIter tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+    SegmentedIter& operator--() noexcept {
+        --i;
+        return *this;
+    }
+    SegmentedIter operator--(int) noexcept {
+        SegmentedIter tmp(*this);
+        --(*this);
+        return tmp;
+    }
+    SegmentedIter& operator+=(difference_type n) noexcept {
+        i += n;
+        return *this;
+    }
+    SegmentedIter& operator-=(difference_type n) noexcept {
+        i -= n;
+        return *this;
+    }
+    friend SegmentedIter operator+(SegmentedIter x, difference_type n) noexcept { return x += n; }
+    friend SegmentedIter operator+(difference_type n, SegmentedIter x) noexcept { return x += n; }
+    friend SegmentedIter operator-(SegmentedIter x, difference_type n) noexcept { return x -= n; }
+    friend difference_type operator-(const SegmentedIter& x, const SegmentedIter& y) noexcept {
+        return static_cast<difference_type>(x.i) - static_cast<difference_type>(y.i);
+    }
+    friend bool operator==(const SegmentedIter& x, const SegmentedIter& y) noexcept { return x.i == y.i; }
+    friend bool operator!=(const SegmentedIter& x, const SegmentedIter& y) noexcept { return x.i != y.i; }
+    friend bool operator<(const SegmentedIter& x, const SegmentedIter& y) noexcept { return x.i < y.i; }
+    friend bool operator>(const SegmentedIter& x, const SegmentedIter& y) noexcept { return y < x; }
+    friend bool operator<=(const SegmentedIter& x, const SegmentedIter& y) noexcept { return !(y < x); }
+    friend bool operator>=(const SegmentedIter& x, const SegmentedIter& y) noexcept { return !(x < y); }
+};
+
+// Elements live in fixed-size chunks which are never moved once allocated,
+// so references and pointers to elements stay valid until the element is erased.
+// Growth only appends a chunk pointer to the map; iterators are invalidated by growth as in a deque.
+template <typename T, typename Allocator = std::allocator<T>>
+class SegmentedVector : private SegmentedVectorBase<T, Allocator> {
+private:
+    using Base = SegmentedVectorBase<T, Allocator>;
+    using MapPointer = typename Base::MapBuffer::pointer;
+    using MapConstPointer = typename Base::MapBuffer::const_pointer;
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using AllocTraits = typename Base::AllocTraits;
+    using reference = typename Base::reference;
+    using const_reference = typename Base::const_reference;
+    using size_type = typename Base::size_type;
+    using difference_type = typename Base::difference_type;
+    using pointer = typename Base::pointer;
+    using const_pointer = typename Base::const_pointer;
+
+    using iterator = SegmentedIter<value_type, pointer, MapConstPointer>;
+    using const_iterator = SegmentedIter<value_type, const_pointer, MapConstPointer>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static_assert(std::is_same_v<typename allocator_type::value_type, value_type>);
+
+    static constexpr size_type chunkSize = Base::chunkSize;
+
+    SegmentedVector() noexcept(std::is_nothrow_default_constructible_v<allocator_type>) {}
+    explicit SegmentedVector(const allocator_type& a) : Base(a) {}
+    explicit SegmentedVector(size_type n, const allocator_type& a = allocator_type());
+    SegmentedVector(size_type n, const value_type& x, const allocator_type& a = allocator_type());
+    SegmentedVector(std::initializer_list<value_type> il, const allocator_type& a = allocator_type());
+    SegmentedVector(const SegmentedVector& x);
+    SegmentedVector(SegmentedVector&& x) noexcept : Base(std::move(x)) {}
+    SegmentedVector& operator=(const SegmentedVector& x);
+    SegmentedVector& operator=(SegmentedVector&& x) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+            || AllocTraits::is_always_equal::value);
+    ~SegmentedVector() = default;
+
+    allocator_type getAllocator() const noexcept { return this->alloc(); }
+
+    iterator begin() noexcept { return iterator(this->map_.begin(), 0); }
+    const_iterator begin() const noexcept { return const_iterator(this->map_.begin(), 0); }
+    iterator end() noexcept { return iterator(this->map_.begin(), size()); }
+    const_iterator end() const noexcept { return const_iterator(this->map_.begin(), size()); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    size_type size() const noexcept { return this->sz(); }
+    size_type capacity() const noexcept { return Base::capacity(); }
+    [[nodiscard]] bool empty() const noexcept { return this->sz() == 0; }
+    size_type maxSize() const noexcept {
+        return std::min<size_type>(AllocTraits::max_size(this->alloc()), std::numeric_limits<difference_type>::max());
+    }
+    void reserve(size_type n);
+    void shrinkToFit() noexcept { this->releaseSpareChunks(); }
+
+    reference operator[](size_type n) noexcept {
+        assert(n < size());
+        return *this->slot(n);
+    }
+    const_reference operator[](size_type n) const noexcept {
+        assert(n < size());
+        return *this->slot(n);
+    }
+    reference at(size_type n);
+    const_reference at(size_type n) const;
+    reference front() noexcept {
+        assert(!empty());
+        return *this->slot(0);
+    }
+    const_reference front() const noexcept {
+        assert(!empty());
+        return *this->slot(0);
+    }
+    reference back() noexcept {
+        assert(!empty());
+        return *this->slot(size() - 1);
+    }
+    const_reference back() const noexcept {
+        assert(!empty());
+        return *this->slot(size() - 1);
+    }
+
+    void pushBack(const_reference x) { emplaceBack(x); }
+    void pushBack(value_type&& x) { emplaceBack(std::move(x)); }
+
+    template <typename... Args>
+    reference emplaceBack(Args&&... args);
+
+    void popBack() noexcept {
+        assert(!empty());
+        this->destructAtEnd(size() - 1);
+    }
+
+    void clear() noexcept { Base::clear(); }
+    void resize(size_type sz);
+    void resize(size_type sz, const_reference x);
+    void swap(SegmentedVector& x) noexcept;
+
+    size_type chunkCount() const noexcept { return (size() + Base::chunkMask) >> Base::chunkShift; }
+    std::span<value_type> chunk(size_type c) noexcept;
+    std::span<const value_type> chunk(size_type c) const noexcept;
+
+    template <typename Function>
+    void forEachChunk(Function f);
+
+    template <typename Function>
+    void parallelForEachChunk(Function f, unsigned threads = std::thread::hardware_concurrency());
+
+    bool Invariants() const;
+
+private:
+    void moveAssign(SegmentedVector& c, std::true_type) noexcept;
+    void moveAssign(SegmentedVector& c, std::false_type) noexcept(AllocTraits::is_always_equal::value);
+};
+
+template <typename T, typename Allocator>
+SegmentedVector<T, Allocator>::SegmentedVector(size_type n, const allocator_type& a) : Base(a) {
+    resize(n);
+}
+
+template <typename T, typename Allocator>
+SegmentedVector<T, Allocator>::SegmentedVector(size_type n, const value_type& x, const allocator_type& a) : Base(a) {
+    resize(n, x);
+}
+
+template <typename T, typename Allocator>
+SegmentedVector<T, Allocator>::SegmentedVector(std::initializer_list<value_type> il, const allocator_type& a) : Base(a) {
+    reserve(il.size());
+    for (const auto& x : il) {
+        emplaceBack(x);
+    }
+}
+
+template <typename T, typename Allocator>
+SegmentedVector<T, Allocator>::SegmentedVector(const SegmentedVector& x)
+: Base(AllocTraits::select_on_container_copy_construction(x.alloc())) {
+    reserve(x.size());
+    for (const auto& v : x) {
+        emplaceBack(v);
+    }
+}
+
+// Keeps this container's chunks unless the allocator propagates and differs, and copies into them.
+template <typename T, typename Allocator>
+SegmentedVector<T, Allocator>& SegmentedVector<T, Allocator>::operator=(const SegmentedVector& x) {
+    if (this != &x) {
+        this->copyAssignAlloc(x);
+        clear();
+        reserve(x.size());
+        for (const auto& v : x) {
+            emplaceBack(v);
+        }
+    }
+    return *this;
+}
+
+template <typename T, typename Allocator>
+inline SegmentedVector<T, Allocator>& SegmentedVector<T, Allocator>::operator=(SegmentedVector&& x)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+    moveAssign(x, std::integral_constant<bool, AllocTraits::propagate_on_container_move_assignment::value>());
+    return *this;
+}
+
+// Chunks from an unequal allocator that stays behind cannot be adopted, so the elements are moved one by one.
+template <typename T, typename Allocator>
+void SegmentedVector<T, Allocator>::moveAssign(SegmentedVector& c, std::false_type) noexcept(AllocTraits::is_always_equal::value) {
+    if (this->alloc() != c.alloc()) {
+        clear();
+        reserve(c.size());
+        for (auto& v : c) {
+            emplaceBack(std::move(v));
+        }
+    } else {
+        moveAssign(c, std::true_type());
+    }
+}
+
+template <typename T, typename Allocator>
+void SegmentedVector<T, Allocator>::moveAssign(SegmentedVector& c, std::true_type) noexcept {
+    clear();
+    this->releaseSpareChunks();
+    this->moveAssignAlloc(c);
+    this->map_ = std::move(c.map_);
+    this->sz() = c.sz();
+    c.sz() = 0;
+}
+
+// Allocators are exchanged only if they propagate on swap; otherwise they must compare equal.
+template <typename T, typename Allocator>
+void SegmentedVector<T, Allocator>::swap(SegmentedVector& x) noexcept {
+    assert(AllocTraits::propagate_on_container_swap::value || this->alloc() == x.alloc());
+    std::swap(this->map_.first_, x.map_.first_);
+    std::swap(this->map_.begin_, x.map_.begin_);
+    std::swap(this->map_.end_, x.map_.end_);
+    std::swap(this->map_.EndCap(), x.map_.EndCap());
+    std::swap(this->sz(), x.sz());
+    this->swapAlloc(x);
+}
+
+template <typename T, typename Allocator>
+void SegmentedVector<T, Allocator>::reserve(size_type n) {
+    if (n > maxSize()) {
+        throw std::length_error("SegmentedVector");
+    }
+    while (capacity() < n) {
+        this->addChunk();
+    }
+}
+
+template <typename T, typename Allocator>
+typename SegmentedVector<T, Allocator>::reference SegmentedVector<T, Allocator>::at(size_type n) {
+    if (n >= size()) {
+        throw std::out_of_range("SegmentedVector");
+    }
+    return *this->slot(n);
+}
+
+template <typename T, typename Allocator>
+typename SegmentedVector<T, Allocator>::const_reference SegmentedVector<T, Allocator>::at(size_type n) const {
+    if (n >= size()) {
+        throw std::out_of_range("SegmentedVector");
+    }
+    return *this->slot(n);
+}
+
+template <typename T, typename Allocator>
+template <typename... Args>
+typename SegmentedVector<T, Allocator>::reference SegmentedVector<T, Allocator>::emplaceBack(Args&&... args) {
+    if (size() == capacity()) {
+        this->addChunk();
+    }
+    pointer p = this->slot(size());
+    AllocTraits::construct(this->alloc(), std::to_address(p), std::forward<Args>(args)...);
+    ++this->sz();
+    return *p;
+}
+
+template <typename T, typename Allocator>
+void SegmentedVector<T, Allocator>::resize(size_type sz) {
+    if (sz < size()) {
+        this->destructAtEnd(sz);
+    } else {
+        reserve(sz);
+        while (size() < sz) {
+            emplaceBack();
+        }
+    }
+}
+
+template <typename T, typename Allocator>
+void SegmentedVector<T, Allocator>::resize(size_type sz, const_reference x) {
+    if (sz < size()) {
+        this->destructAtEnd(sz);
+    } else {
+        reserve(sz);
+        while (size() < sz) {
+            emplaceBack(x);
+        }
+    }
+}
+
+template <typename T, typename Allocator>
+std::span<typename SegmentedVector<T, Allocator>::value_type> SegmentedVector<T, Allocator>::chunk(size_type c) noexcept {
+    assert(c < chunkCount());
+    size_type first = c << Base::chunkShift;
+    return {std::to_address(this->map_.begin_[c]), std::min(chunkSize, size() - first)};
+}
+
+template <typename T, typename Allocator>
+std::span<const typename SegmentedVector<T, Allocator>::value_type> SegmentedVector<T, Allocator>::chunk(size_type c) const noexcept {
+    assert(c < chunkCount());
+    size_type first = c << Base::chunkShift;
+    return {std::to_address(this->map_.begin_[c]), std::min(chunkSize, size() - first)};
+}
+
+template <typename T, typename Allocator>
+template <typename Function>
+void SegmentedVector<T, Allocator>::forEachChunk(Function f) {
+    for (size_type c = 0, n = chunkCount(); c < n; ++c) {
+        f(chunk(c));
+    }
+}
+
+template <typename T, typename Allocator>
+template <typename Function>
+void SegmentedVector<T, Allocator>::parallelForEachChunk(Function f, unsigned threads) {
+    size_type n = chunkCount();
+    size_type workers = std::clamp<size_type>(threads, 1, std::max<size_type>(n, 1));
+    if (workers == 1) {
+        forEachChunk(f);
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    size_type step = n / workers;
+    size_type extra = n % workers;
+    size_type first = 0;
+    for (size_type w = 0; w < workers; ++w) {
+        size_type last = first + step + (w < extra ? 1 : 0);
+        auto work = [this, &f, first, last] {
+            for (size_type c = first; c < last; ++c) {
+                f(chunk(c));
+            }
+        };
+        if (w + 1 == workers) {
+            work();
+        } else {
+            pool.emplace_back(work);
+        }
+        first = last;
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+template <typename T, typename Allocator>
+bool SegmentedVector<T, Allocator>::Invariants() const {
+    if (size() > capacity()) {
+        return false;
+    }
+    if (capacity() != this->map_.size() * chunkSize) {
+        return false;
+    }
+    return this->map_.Invariants();
+}
+
+template <typename T, typename Allocator>
+inline bool operator==(const SegmentedVector<T, Allocator>& x, const SegmentedVector<T, Allocator>& y) {
+    return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+}
+
+template <typename T, typename Allocator>
+inline bool operator!=(const SegmentedVector<T, Allocator>& x, const SegmentedVector<T, Allocator>& y) {
+    return !(x == y);
+}
+
+template <typename Container>
+std::chrono::nanoseconds worstPushBack(Container& c, int n) {
+    std::chrono::nanoseconds worst {0};
+    for (int i = 0; i < n; i++) {
+        auto t1 = std::chrono::steady_clock::now();
+        c.push_back(i);
+        auto t2 = std::chrono::steady_clock::now();
+        worst = std::max(worst, std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1));
+    }
+    return worst;
+}
+
+struct SegmentedPushBack : SegmentedVector<int> {
+    void push_back(int x) { pushBack(x); }
+};
+
+// A ProfilingAllocator that travels with the contents on copy assignment, move assignment and swap.
+template <typename T>
+struct PropagatingAllocator : ProfilingAllocator<T> {
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = PropagatingAllocator<U>;
+    };
+
+    PropagatingAllocator() noexcept = default;
+    explicit PropagatingAllocator(const char* tag) noexcept : ProfilingAllocator<T>(tag) {}
+
+    template <typename U>
+    PropagatingAllocator(const PropagatingAllocator<U>& a) noexcept : ProfilingAllocator<T>(a) {}
+};
+
+int main(int argc, char* argv[]) {
+    SegmentedVector<int> sv;
+    sv.pushBack(0);
+    const int* first = &sv.front();
+    for (int i = 1; i < 1'000'000; i++) {
+        sv.pushBack(i);
+    }
+    assert(first == &sv[0]);
+    assert(sv.Invariants());
+    assert(std::is_sorted(sv.begin(), sv.end()));
+
+    std::atomic<long long> sum {0};
+    sv.parallelForEachChunk([&sum](std::span<int> c) {
+        sum += std::accumulate(c.begin(), c.end(), 0LL);
+    });
+    assert(sum == 999'999LL * 1'000'000 / 2);
+
+    // HugePageAllocator from 19-8 as Vector's Alloc: once the buffer reaches 2 MB it gets its own aligned mapping.
+    {
+        Vector<size_t, HugePageAllocator<size_t>> huge;
+        for (size_t i = 0; i < HugePageSize; i++) {
+            huge.pushBack(i);
+        }
+        assert(reinterpret_cast<std::uintptr_t>(&huge[0]) % HugePageSize == 0);
+        assert(std::accumulate(huge.begin(), huge.end(), size_t {0}) == HugePageSize * (HugePageSize - 1) / 2);
+        Vector<size_t, HugePageAllocator<size_t>> copy = huge;
+        assert(copy.size() == huge.size() && copy.getAllocator() == huge.getAllocator());
+    }
+
+    // ProfilingAllocator from 19-8 as Vector's Alloc: each regrowth is one allocation under the tag.
+    AllocationRegistry::instance().setReportAtExit(false);
+    {
+        Vector<int, ProfilingAllocator<int>> profiled(ProfilingAllocator<int>("Vector pushBack"));
+        for (int i = 0; i < 1'000; i++) {
+            profiled.pushBack(i);
+        }
+        auto live = AllocationRegistry::instance().stats("Vector pushBack");
+        assert(live.allocations > 1 && live.allocations < 20 && live.bytesLive == profiled.capacity() * sizeof(int));
+    }
+    auto vectorBuffers = AllocationRegistry::instance().stats("Vector pushBack");
+    assert(vectorBuffers.allocations == vectorBuffers.deallocations && vectorBuffers.bytesLive == 0);
+
+    // Assignment between SegmentedVectors with differently tagged allocators: a plain ProfilingAllocator stays with
+    // its container and the elements are copied or moved across, a propagating one goes with the contents.
+    {
+        using Tagged = SegmentedVector<int, ProfilingAllocator<int>>;
+        Tagged a(3'000, 7, ProfilingAllocator<int>("SegmentedVector a"));
+        Tagged b(ProfilingAllocator<int>("SegmentedVector b"));
+        b = a;
+        assert(b == a && std::string_view(b.getAllocator().tag()) == "SegmentedVector b");
+        Tagged c(ProfilingAllocator<int>("SegmentedVector c"));
+        c = std::move(a);
+        assert(c == b && std::string_view(c.getAllocator().tag()) == "SegmentedVector c" && c.Invariants());
+
+        using Propagating = SegmentedVector<int, PropagatingAllocator<int>>;
+        Propagating p(3'000, 7, PropagatingAllocator<int>("SegmentedVector p"));
+        Propagating q(10, 1, PropagatingAllocator<int>("SegmentedVector q"));
+        q = p;
+        assert(q == p && q.getAllocator() == p.getAllocator());
+        assert(AllocationRegistry::instance().stats("SegmentedVector q").bytesLive == 0);
+        Propagating r(PropagatingAllocator<int>("SegmentedVector r"));
+        r.swap(q);
+        assert(r == p && r.getAllocator() == p.getAllocator() && q.empty());
+        assert(std::string_view(q.getAllocator().tag()) == "SegmentedVector r");
+        q = std::move(r);
+        assert(q == p && q.getAllocator() == p.getAllocator() && r.empty() && q.Invariants());
+    }
+    for (const char* tag : {"SegmentedVector a", "SegmentedVector b", "SegmentedVector c", "SegmentedVector p",
+                            "SegmentedVector q", "SegmentedVector r"}) {
+        auto stats = AllocationRegistry::instance().stats(tag);
+        assert(stats.allocations == stats.deallocations && stats.bytesLive == 0);
+    }
+
+    constexpr int N = 10'000'000;
+    std::vector<int> v;
+    SegmentedPushBack s;
+    std::cout << "std::vector worst pushBack : " << worstPushBack(v, N).count() << "ns\n";
+    std::cout << "SegmentedVector worst pushBack : " << worstPushBack(s, N).count() << "ns\n";
+
+    // The sorted-insertion experiment of 20-20, with this file's container as a contender. It takes the
+    // same options as 20-20: --csv or --json, --repetitions=N, --warmup=N, --no-flush, --no-counters.
+    BenchmarkSuite suite(BenchmarkOptions::fromArgs(argc, argv));
+    for (size_t n : {128, 512, 2048}) {
+        addSortedInsert<std::vector<int>>(suite, "std::vector", n);
+        addSortedInsert<Vector<int, std::allocator<int>>>(suite, "Vector", n);
+    }
+    suite.run();
+    suite.write(std::cout);
 
 }
\ No newline at end of file
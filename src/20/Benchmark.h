@@ -0,0 +1,460 @@
+#ifndef PPP_BENCHMARK_H
+#define PPP_BENCHMARK_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters of the calling thread, read through perf_event_open. A counter that cannot be
+// opened (no permission under perf_event_paranoid, a virtual machine without a PMU, not Linux)
+// reads as -1 while the others keep counting. Only user-space events are counted.
+class PerfCounters {
+public:
+    enum Event { CacheMisses, BranchMisses, Instructions, Events };
+
+    static constexpr std::array<const char*, Events> names {"cache-misses", "branch-misses", "instructions"};
+
+    using Values = std::array<long long, Events>;
+
+    PerfCounters() {
+#if defined(__linux__)
+        constexpr std::array<uint64_t, Events> configs {PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+                                                        PERF_COUNT_HW_INSTRUCTIONS};
+        for (size_t e = 0; e < Events; e++) {
+            perf_event_attr attr {};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    bool available() const noexcept {
+        return std::any_of(fds.begin(), fds.end(), [](int fd) { return fd >= 0; });
+    }
+
+    void start() noexcept {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    Values stop() noexcept {
+        Values values;
+        values.fill(-1);
+#if defined(__linux__)
+        for (size_t e = 0; e < Events; e++) {
+            if (fds[e] >= 0) {
+                ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+                long long count;
+                if (read(fds[e], &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count))) {
+                    values[e] = count;
+                }
+            }
+        }
+#endif
+        return values;
+    }
+
+private:
+    std::array<int, Events> fds {-1, -1, -1};
+};
+
+// Evicts a benchmark's data from the caches between runs by writing every line of a buffer twice the
+// size of the last-level cache (at least 32 MB when the size is not reported).
+class CacheFlusher {
+public:
+    CacheFlusher() : buffer(bufferBytes()) {}
+
+    void flush() noexcept {
+        for (size_t i = 0; i < buffer.size(); i += 64) {
+            buffer[i]++;
+        }
+        sink = std::accumulate(buffer.begin(), buffer.begin() + 64, sink);
+    }
+
+private:
+    std::vector<unsigned char> buffer;
+    volatile unsigned sink = 0;
+
+    static size_t bufferBytes() {
+        long l3 = -1;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+        l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+        return std::max<size_t>(32 << 20, l3 > 0 ? 2 * static_cast<size_t>(l3) : 0);
+    }
+};
+
+enum class BenchmarkFormat { Table, Csv, Json };
+
+struct BenchmarkOptions {
+    size_t warmup = 3;
+    size_t repetitions = 31;
+    bool flushCache = true;
+    bool counters = true;
+    BenchmarkFormat format = BenchmarkFormat::Table;
+
+    // Reads --csv, --json, --warmup=N, --repetitions=N, --no-flush and --no-counters; other arguments are left alone.
+    static BenchmarkOptions fromArgs(int argc, char* argv[]) {
+        BenchmarkOptions options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--csv") {
+                options.format = BenchmarkFormat::Csv;
+            } else if (arg == "--json") {
+                options.format = BenchmarkFormat::Json;
+            } else if (arg == "--no-flush") {
+                options.flushCache = false;
+            } else if (arg == "--no-counters") {
+                options.counters = false;
+            } else if (arg.starts_with("--warmup=")) {
+                options.warmup = std::stoul(std::string(arg.substr(9)));
+            } else if (arg.starts_with("--repetitions=")) {
+                options.repetitions = std::max<size_t>(1, std::stoul(std::string(arg.substr(14))));
+            }
+        }
+        return options;
+    }
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t n;
+    std::vector<double> ns;
+    double min;
+    double median;
+    double mean;
+    double p99;
+    // Median per run, or -1 when the counter is unavailable.
+    std::array<double, PerfCounters::Events> counters;
+};
+
+// Runs registered cases and summarises them. A case is a name, a size and a prepare function that
+// builds its input untimed and returns the operation to time. Each case gets warm-up runs, then
+// repetitions that each start from a fresh prepare and, optionally, cold caches; only the returned
+// operation is inside the timer and the counters. Results are medians and 99th percentiles over the
+// repetitions, written as a table, CSV or JSON.
+class BenchmarkSuite {
+public:
+    using Run = std::function<void()>;
+    using Prepare = std::function<Run()>;
+
+    // A prepared repetition whose result is checked once the timer has stopped.
+    struct Checked {
+        Run run;
+        Run check;
+    };
+    using PrepareChecked = std::function<Checked()>;
+
+    explicit BenchmarkSuite(BenchmarkOptions options = {}) : options {options} {}
+
+    void add(std::string name, size_t n, Prepare prepare) {
+        addChecked(std::move(name), n, [prepare = std::move(prepare)] { return Checked {prepare(), {}}; });
+    }
+
+    void addChecked(std::string name, size_t n, PrepareChecked prepare) {
+        cases.push_back({std::move(name), n, std::move(prepare)});
+    }
+
+    const std::vector<BenchmarkResult>& run() {
+        std::unique_ptr<CacheFlusher> flusher;
+        if (options.flushCache) {
+            flusher = std::make_unique<CacheFlusher>();
+        }
+        std::unique_ptr<PerfCounters> perf;
+        if (options.counters) {
+            perf = std::make_unique<PerfCounters>();
+        }
+        results.clear();
+        for (auto& c : cases) {
+            for (size_t i = 0; i < options.warmup; i++) {
+                Checked op = c.prepare();
+                op.run();
+                if (op.check) {
+                    op.check();
+                }
+            }
+            BenchmarkResult r {c.name, c.n, {}, 0, 0, 0, 0, {}};
+            std::array<std::vector<long long>, PerfCounters::Events> counts;
+            for (size_t i = 0; i < options.repetitions; i++) {
+                Checked op = c.prepare();
+                if (flusher) {
+                    flusher->flush();
+                }
+                if (perf) {
+                    perf->start();
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                op.run();
+                auto t2 = std::chrono::steady_clock::now();
+                if (perf) {
+                    auto values = perf->stop();
+                    for (size_t e = 0; e < PerfCounters::Events; e++) {
+                        counts[e].push_back(values[e]);
+                    }
+                }
+                r.ns.push_back(std::chrono::duration<double, std::nano>(t2 - t1).count());
+                if (op.check) {
+                    op.check();
+                }
+            }
+            std::vector<double> sorted = r.ns;
+            std::sort(sorted.begin(), sorted.end());
+            r.min = sorted.front();
+            r.median = percentile(sorted, 0.5);
+            r.p99 = percentile(sorted, 0.99);
+            r.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+            for (size_t e = 0; e < PerfCounters::Events; e++) {
+                std::vector<double> v(counts[e].begin(), counts[e].end());
+                std::sort(v.begin(), v.end());
+                r.counters[e] = v.empty() || v.front() < 0 ? -1 : percentile(v, 0.5);
+            }
+            results.push_back(std::move(r));
+        }
+        return results;
+    }
+
+    void write(std::ostream& os) const {
+        switch (options.format) {
+            case BenchmarkFormat::Table:
+                writeTable(os);
+                break;
+            case BenchmarkFormat::Csv:
+                writeCsv(os);
+                break;
+            case BenchmarkFormat::Json:
+                writeJson(os);
+                break;
+        }
+    }
+
+    void writeTable(std::ostream& os) const {
+        size_t width = 4;
+        for (auto& r : results) {
+            width = std::max(width, r.name.size());
+        }
+        std::string line;
+        auto cell = [&line](std::string_view s, size_t w) {
+            line += s;
+            line.append(w > s.size() ? w - s.size() : 0, ' ');
+        };
+        auto flush = [&os, &line] {
+            line.erase(line.find_last_not_of(' ') + 1);
+            os << line << "\n";
+            line.clear();
+        };
+        cell("case", width + 2);
+        cell("n", 10);
+        cell("median us", 12);
+        cell("p99 us", 12);
+        cell("min us", 12);
+        for (auto name : PerfCounters::names) {
+            cell(name, 16);
+        }
+        flush();
+        for (auto& r : results) {
+            cell(r.name, width + 2);
+            cell(std::to_string(r.n), 10);
+            cell(fixed(r.median / 1e3), 12);
+            cell(fixed(r.p99 / 1e3), 12);
+            cell(fixed(r.min / 1e3), 12);
+            for (double c : r.counters) {
+                cell(c < 0 ? "n/a" : std::to_string(std::llround(c)), 16);
+            }
+            flush();
+        }
+    }
+
+    void writeCsv(std::ostream& os) const {
+        os << "case,n,repetitions,min_ns,median_ns,mean_ns,p99_ns";
+        for (auto name : PerfCounters::names) {
+            os << "," << name;
+        }
+        os << "\n";
+        for (auto& r : results) {
+            os << quoted(r.name, false) << "," << r.n << "," << r.ns.size() << "," << std::llround(r.min) << ","
+               << std::llround(r.median) << "," << std::llround(r.mean) << "," << std::llround(r.p99);
+            for (double c : r.counters) {
+                os << ",";
+                if (c >= 0) {
+                    os << std::llround(c);
+                }
+            }
+            os << "\n";
+        }
+    }
+
+    void writeJson(std::ostream& os) const {
+        os << "[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            auto& r = results[i];
+            os << "  {\"case\": " << quoted(r.name, true) << ", \"n\": " << r.n << ", \"repetitions\": " << r.ns.size()
+               << ", \"min_ns\": " << std::llround(r.min) << ", \"median_ns\": " << std::llround(r.median)
+               << ", \"mean_ns\": " << std::llround(r.mean) << ", \"p99_ns\": " << std::llround(r.p99);
+            for (size_t e = 0; e < PerfCounters::Events; e++) {
+                os << ", \"" << PerfCounters::names[e] << "\": ";
+                if (r.counters[e] < 0) {
+                    os << "null";
+                } else {
+                    os << std::llround(r.counters[e]);
+                }
+            }
+            os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        os << "]\n";
+    }
+
+private:
+    struct Case {
+        std::string name;
+        size_t n;
+        PrepareChecked prepare;
+    };
+
+    BenchmarkOptions options;
+    std::vector<Case> cases;
+    std::vector<BenchmarkResult> results;
+
+    // Nearest-rank percentile of sorted values.
+    static double percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    static std::string fixed(double x) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), x >= 100 ? "%.0f" : "%.2f", x);
+        return buf;
+    }
+
+    // CSV doubles embedded quotes, JSON escapes quotes and backslashes.
+    static std::string quoted(const std::string& s, bool json) {
+        std::string q = "\"";
+        for (char c : s) {
+            if (c == '"') {
+                q += json ? '\\' : '"';
+            } else if (c == '\\' && json) {
+                q += '\\';
+            }
+            q += c;
+        }
+        return q + "\"";
+    }
+};
+
+// Inserts x so that c stays sorted: forward lists and sequences find the position by a linear search
+// or std::lower_bound, ordered containers (anything with a key_type, or an insert taking only the key)
+// place it themselves.
+template <typename Container, typename T>
+void insertSorted(Container& c, const T& x) {
+    if constexpr (requires { c.insertAfter(c.beforeBegin(), x); }) {
+        auto prev = c.beforeBegin();
+        for (auto it = c.begin(); it != c.end() && *it < x; ++it) {
+            prev = it;
+        }
+        c.insertAfter(prev, x);
+    } else if constexpr (requires { c.insert_after(c.before_begin(), x); }) {
+        auto prev = c.before_begin();
+        for (auto it = c.begin(); it != c.end() && *it < x; ++it) {
+            prev = it;
+        }
+        c.insert_after(prev, x);
+    } else if constexpr (requires { typename Container::key_type; }) {
+        c.insert(x);
+    } else if constexpr (requires { c.insert(c.end(), x); }) {
+        c.insert(std::lower_bound(c.begin(), c.end(), x), x);
+    } else {
+        c.insert(x);
+    }
+}
+
+// Whether insertSorted keeps every copy of a repeated key: forward lists and sequences do, ordered
+// containers keep one.
+template <typename Container, typename T>
+inline constexpr bool insertSortedKeepsDuplicates =
+    requires(Container& c, const T& x) { c.insertAfter(c.beforeBegin(), x); } ||
+    requires(Container& c, const T& x) { c.insert_after(c.before_begin(), x); } ||
+    (!requires { typename Container::key_type; } && requires(Container& c, const T& x) { c.insert(c.end(), x); });
+
+// Registers the sorted-insertion experiment of 20-20: n random ints from [0, n] inserted one by one
+// into a container made by make, keeping it sorted. The keys and the empty container are prepared
+// outside the timer; after it, the container is checked to hold exactly the sorted keys (without repeats
+// for ordered containers) and destroyed.
+template <typename Container, typename Make>
+void addSortedInsert(BenchmarkSuite& suite, std::string name, size_t n, Make make) {
+    suite.addChecked(std::move(name), n, [n, make] {
+        std::mt19937 gen(std::random_device {}());
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(n));
+        std::vector<int> keys(n);
+        for (auto& k : keys) {
+            k = dist(gen);
+        }
+        std::vector<int> expected = keys;
+        std::sort(expected.begin(), expected.end());
+        if constexpr (!insertSortedKeepsDuplicates<Container, int>) {
+            expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        }
+        std::shared_ptr<Container> c = make();
+        auto run = [c, keys = std::move(keys)] {
+            for (int k : keys) {
+                insertSorted(*c, k);
+            }
+        };
+        auto check = [c, expected = std::move(expected)] {
+            assert(std::equal(c->begin(), c->end(), expected.begin(), expected.end()));
+        };
+        return BenchmarkSuite::Checked {run, check};
+    });
+}
+
+template <typename Container>
+void addSortedInsert(BenchmarkSuite& suite, std::string name, size_t n) {
+    addSortedInsert<Container>(suite, std::move(name), n, [] { return std::make_unique<Container>(); });
+}
+
+
+#endif //PPP_BENCHMARK_H
\ No newline at end of file
@@ -0,0 +1,232 @@
+#ifndef PPP_NODEPOOL_H
+#define PPP_NODEPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Carves fixed-size blocks out of large slabs and recycles freed blocks through an intrusive free list.
+// Fresh blocks are handed out in address order, so nodes inserted together stay neighbours in memory.
+class NodePool {
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Slab {
+        Slab* next;
+    };
+
+    size_t blockSize;
+    size_t blockAlign;
+    size_t slabBytes;
+    FreeBlock* freeList = nullptr;
+    Slab* slabs = nullptr;
+    std::byte* cursor = nullptr;
+    std::byte* slabEnd = nullptr;
+
+    void grow() {
+        auto* slab = static_cast<Slab*>(::operator new(slabBytes, std::align_val_t {alignof(std::max_align_t)}));
+        slab->next = slabs;
+        slabs = slab;
+        auto first = reinterpret_cast<std::uintptr_t>(slab + 1);
+        first = (first + blockAlign - 1) & ~(blockAlign - 1);
+        cursor = reinterpret_cast<std::byte*>(first);
+        slabEnd = reinterpret_cast<std::byte*>(slab) + slabBytes;
+    }
+
+public:
+    NodePool(size_t size, size_t align, size_t slab = 64 * 1024)
+    : blockAlign {std::max(align, alignof(FreeBlock))}, slabBytes {slab} {
+        blockSize = (std::max(size, sizeof(FreeBlock)) + blockAlign - 1) & ~(blockAlign - 1);
+        slabBytes = std::max(slabBytes, sizeof(Slab) + blockAlign + blockSize);
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        while (slabs) {
+            Slab* next = slabs->next;
+            ::operator delete(slabs, std::align_val_t {alignof(std::max_align_t)});
+            slabs = next;
+        }
+    }
+
+    size_t size() const noexcept { return blockSize; }
+
+    void* allocate() {
+        if (freeList) {
+            FreeBlock* b = freeList;
+            freeList = b->next;
+            return b;
+        }
+        if (cursor == nullptr || static_cast<size_t>(slabEnd - cursor) < blockSize) {
+            grow();
+        }
+        void* p = cursor;
+        cursor += blockSize;
+        return p;
+    }
+
+    void deallocate(void* p) noexcept {
+        auto* b = static_cast<FreeBlock*>(p);
+        b->next = freeList;
+        freeList = b;
+    }
+};
+
+// Owns the pools of one allocator family, one pool per block size and alignment.
+// Rebound copies of an allocator share the resource and find their node type's pool in it,
+// so a block always returns to the pool it came from.
+class NodePoolResource {
+    std::mutex m;
+    std::map<std::pair<size_t, size_t>, std::unique_ptr<NodePool>> pools;
+
+public:
+    NodePool& pool(size_t size, size_t align) {
+        std::lock_guard<std::mutex> lock(m);
+        auto& p = pools[{size, align}];
+        if (!p) {
+            p = std::make_unique<NodePool>(size, align);
+        }
+        return *p;
+    }
+};
+
+// Owns every thread's pool. A thread hands its pool back when it exits and a later thread adopts it,
+// since blocks carved from it may still be in use elsewhere; the pools are freed at program exit.
+class ThreadNodePools {
+    std::mutex m;
+    std::vector<std::unique_ptr<NodePool>> pools;
+    std::map<std::pair<size_t, size_t>, std::vector<NodePool*>> idle;
+
+public:
+    static ThreadNodePools& instance() {
+        static ThreadNodePools registry;
+        return registry;
+    }
+
+    NodePool* acquire(size_t size, size_t align) {
+        std::lock_guard<std::mutex> lock(m);
+        auto& free = idle[{size, align}];
+        if (!free.empty()) {
+            NodePool* p = free.back();
+            free.pop_back();
+            return p;
+        }
+        return pools.emplace_back(std::make_unique<NodePool>(size, align)).get();
+    }
+
+    void release(NodePool* p, size_t size, size_t align) {
+        std::lock_guard<std::mutex> lock(m);
+        idle[{size, align}].push_back(p);
+    }
+};
+
+// Single-node requests are served from a NodePool; anything else goes to ::operator new.
+// By default every container gets its own NodePoolResource, shared by the copies and rebinds of its allocator.
+// With ThreadLocal each thread allocates from its own pool; a block may be freed on any thread
+// and then feeds that thread's free list. Containers using it must not outlive main's statics.
+template <typename T, bool ThreadLocal = false>
+class NodePoolAllocator {
+public:
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::bool_constant<ThreadLocal>;
+
+    template <typename U>
+    struct rebind {
+        using other = NodePoolAllocator<U, ThreadLocal>;
+    };
+
+    template <typename U, bool L>
+    friend class NodePoolAllocator;
+
+    NodePoolAllocator() : NodePoolAllocator(makeResource()) {}
+
+    template <typename U>
+    NodePoolAllocator(const NodePoolAllocator<U, ThreadLocal>& a) : NodePoolAllocator(a.resource_) {}
+
+    NodePoolAllocator select_on_container_copy_construction() const {
+        return NodePoolAllocator();
+    }
+
+    [[nodiscard]] pointer allocate(size_type n) {
+        if (n != 1) {
+            return static_cast<pointer>(::operator new(n * sizeof(T), std::align_val_t {alignof(T)}));
+        }
+        return static_cast<pointer>(pool().allocate());
+    }
+
+    void deallocate(pointer p, size_type n) noexcept {
+        if (n != 1) {
+            ::operator delete(p, std::align_val_t {alignof(T)});
+        } else {
+            pool().deallocate(p);
+        }
+    }
+
+    template <typename U>
+    bool sameResource(const NodePoolAllocator<U, ThreadLocal>& a) const noexcept {
+        return resource_ == a.resource_;
+    }
+
+private:
+    std::shared_ptr<NodePoolResource> resource_;
+    NodePool* pool_;
+
+    explicit NodePoolAllocator(std::shared_ptr<NodePoolResource> resource)
+    : resource_ {std::move(resource)}, pool_ {resource_ ? &resource_->pool(sizeof(T), alignof(T)) : nullptr} {}
+
+    static std::shared_ptr<NodePoolResource> makeResource() {
+        if constexpr (ThreadLocal) {
+            return nullptr;
+        } else {
+            return std::make_shared<NodePoolResource>();
+        }
+    }
+
+    struct ThreadPool {
+        NodePool* pool = ThreadNodePools::instance().acquire(sizeof(T), alignof(T));
+
+        ~ThreadPool() {
+            ThreadNodePools::instance().release(pool, sizeof(T), alignof(T));
+        }
+    };
+
+    NodePool& pool() const noexcept {
+        if constexpr (ThreadLocal) {
+            static thread_local ThreadPool local;
+            return *local.pool;
+        } else {
+            return *pool_;
+        }
+    }
+};
+
+template <typename T, typename U, bool ThreadLocal>
+bool operator==(const NodePoolAllocator<T, ThreadLocal>& a1, const NodePoolAllocator<U, ThreadLocal>& a2) noexcept {
+    return a1.sameResource(a2);
+}
+
+template <typename T, typename U, bool ThreadLocal>
+bool operator!=(const NodePoolAllocator<T, ThreadLocal>& a1, const NodePoolAllocator<U, ThreadLocal>& a2) noexcept {
+    return !(a1 == a2);
+}
+
+#endif //PPP_NODEPOOL_H
\ No newline at end of file
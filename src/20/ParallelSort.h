@@ -0,0 +1,80 @@
+#ifndef PPP_PARALLELSORT_H
+#define PPP_PARALLELSORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline constexpr size_t ParallelSortMinRun = size_t {1} << 14;
+
+// Stable merge of [f1, l1) and [f2, l2) into out, cut into pieces that are merged concurrently.
+// Each cut at x = *m1 sends the elements of the second range that are less than x to the left piece,
+// so equal elements keep coming from the first range first.
+template <typename Iter, typename OutIter, typename Comp>
+void ParallelMerge(Iter f1, Iter l1, Iter f2, Iter l2, OutIter out, Comp& comp,
+                   size_t pieces, std::vector<std::thread>& pool) {
+    size_t n1 = static_cast<size_t>(l1 - f1);
+    if (n1 == 0) {
+        pieces = 1;
+    }
+    const Iter b1 = f1;
+    for (size_t k = 1; k <= pieces; k++) {
+        Iter m1 = k == pieces ? l1 : b1 + static_cast<std::ptrdiff_t>(n1 * k / pieces);
+        Iter m2 = k == pieces ? l2 : std::lower_bound(f2, l2, *m1, comp);
+        pool.emplace_back([=, &comp] { std::merge(f1, m1, f2, m2, out, comp); });
+        out += (m1 - f1) + (m2 - f2);
+        f1 = m1;
+        f2 = m2;
+    }
+}
+
+// Stable sort of a contiguous array: threads stable-sort one run each,
+// then neighbouring runs are merged level by level, ping-ponging between v and a buffer.
+template <typename T, typename Comp>
+void ParallelStableSort(std::vector<T>& v, Comp comp, unsigned threads) {
+    size_t n = v.size();
+    size_t runs = std::clamp<size_t>(threads, 1, std::max<size_t>(n / ParallelSortMinRun, 1));
+    if (runs == 1) {
+        std::stable_sort(v.begin(), v.end(), comp);
+        return;
+    }
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t r = 0; r <= runs; r++) {
+        bounds[r] = n * r / runs;
+    }
+    std::vector<std::thread> pool;
+    for (size_t r = 0; r < runs; r++) {
+        pool.emplace_back([&v, &comp, lo = bounds[r], hi = bounds[r + 1]] {
+            std::stable_sort(v.begin() + lo, v.begin() + hi, comp);
+        });
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+    std::vector<T> buf(n);
+    while (bounds.size() > 2) {
+        pool.clear();
+        std::vector<size_t> next;
+        size_t pairs = (bounds.size() - 1) / 2;
+        size_t pieces = std::max<size_t>(threads / std::max<size_t>(pairs, 1), 1);
+        for (size_t r = 0; r + 1 < bounds.size(); r += 2) {
+            next.push_back(bounds[r]);
+            if (r + 2 < bounds.size()) {
+                ParallelMerge(v.begin() + bounds[r], v.begin() + bounds[r + 1],
+                              v.begin() + bounds[r + 1], v.begin() + bounds[r + 2],
+                              buf.begin() + bounds[r], comp, pieces, pool);
+            } else {
+                std::copy(v.begin() + bounds[r], v.begin() + bounds[r + 1], buf.begin() + bounds[r]);
+            }
+        }
+        next.push_back(n);
+        for (auto& t : pool) {
+            t.join();
+        }
+        v.swap(buf);
+        bounds.swap(next);
+    }
+}
+
+#endif //PPP_PARALLELSORT_H
\ No newline at end of file
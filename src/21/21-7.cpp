@@ -1,5 +1,19 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <random>
+#include <ranges>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 template <typename Compare, typename ForwardIterator, typename T>
 constexpr ForwardIterator LowerBound(ForwardIterator first, ForwardIterator last, const T& value, Compare comp) {
@@ -19,20 +33,48 @@ constexpr ForwardIterator LowerBound(ForwardIterator first, ForwardIterator last
     return first;
 }
 
+// Branchless lower bound for contiguous ranges. The window [base, base + len] halves on every step
+// whatever the comparison says, so the loop runs a fixed log2(n) times and the comparison only picks
+// the next base, which compiles to a conditional move instead of a mispredicted branch. Both candidate
+// midpoints of the following step are prefetched, so large arrays overlap two cache misses per probe.
+template <typename Compare, std::contiguous_iterator Iterator, typename T>
+constexpr Iterator BranchlessLowerBound(Iterator first, Iterator last, const T& value, Compare comp) {
+    auto* base = std::to_address(first);
+    size_t len = static_cast<size_t>(last - first);
+    if (len == 0) {
+        return first;
+    }
+    while (len > 1) {
+        size_t half = len / 2;
+        if (!std::is_constant_evaluated()) {
+            __builtin_prefetch(base + half / 2);
+            __builtin_prefetch(base + half + half / 2);
+        }
+        base = comp(base[half], value) ? base + half : base;
+        len -= half;
+    }
+    base += comp(*base, value);
+    return first + (base - std::to_address(first));
+}
+
 template <typename ForwardIterator, typename T, typename Compare>
 [[nodiscard]] inline constexpr ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last, const T& value, Compare comp) {
     using CompRef = typename std::add_lvalue_reference_t<Compare>;
-    return LowerBound<CompRef>(first, last, value, comp);
+    if constexpr (std::contiguous_iterator<ForwardIterator>) {
+        return BranchlessLowerBound<CompRef>(first, last, value, comp);
+    } else {
+        return LowerBound<CompRef>(first, last, value, comp);
+    }
 }
 
 template <typename ForwardIterator, typename T>
 [[nodiscard]] inline constexpr ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last, const T& value) {
-    return lower_bound(first, last, value, std::less<T>());
+    return ::lower_bound(first, last, value, std::less<T>());
 }
 
 template <typename Compare, typename ForwardIterator, typename T>
 inline constexpr bool BinarySearch(ForwardIterator first, ForwardIterator last, const T& value, Compare comp) {
-    first = lower_bound<Compare>(first, last, value, comp);
+    first = ::lower_bound(first, last, value, comp);
     return first != last && !comp(value, *first);
 }
 
@@ -44,9 +86,251 @@ template <typename ForwardIterator, typename T, typename Compare>
 
 template <typename ForwardIterator, typename T>
 [[nodiscard]] inline constexpr bool binary_search(ForwardIterator first, ForwardIterator last, const T& value) {
-    return binary_search(first, last, value, std::less<T>());
+    return ::binary_search(first, last, value, std::less<T>());
 }
 
-int main() {
+// Answers LowerBound for every query in [queries, queriesLast) into out. The step sequence of the
+// branchless search depends only on the range length, so Group searches advance in lockstep and
+// their independent loads are in flight at the same time instead of one after another.
+template <size_t Group = 16, typename Compare, std::contiguous_iterator Iterator, typename QueryIterator, typename OutputIterator>
+void LowerBoundBatch(Iterator first, Iterator last, QueryIterator queries, QueryIterator queriesLast, OutputIterator out, Compare comp) {
+    using Pointer = decltype(std::to_address(first));
+    size_t n = static_cast<size_t>(last - first);
+    while (queries != queriesLast) {
+        size_t m = std::min<size_t>(Group, static_cast<size_t>(std::distance(queries, queriesLast)));
+        Pointer base[Group];
+        std::fill_n(base, m, std::to_address(first));
+        if (n > 0) {
+            for (size_t len = n; len > 1;) {
+                size_t half = len / 2;
+                for (size_t g = 0; g < m; g++) {
+                    __builtin_prefetch(base[g] + half / 2);
+                    __builtin_prefetch(base[g] + half + half / 2);
+                    base[g] = comp(base[g][half], queries[g]) ? base[g] + half : base[g];
+                }
+                len -= half;
+            }
+            for (size_t g = 0; g < m; g++) {
+                base[g] += comp(*base[g], queries[g]);
+            }
+        }
+        for (size_t g = 0; g < m; g++) {
+            *out++ = first + (base[g] - std::to_address(first));
+        }
+        std::advance(queries, m);
+    }
+}
+
+// Allocator handing out cache-line aligned storage.
+template <typename T>
+struct CacheAlignedAllocator {
+    using value_type = T;
+    static constexpr std::align_val_t Alignment {64};
+
+    CacheAlignedAllocator() noexcept = default;
+
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), Alignment));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ::operator delete(p, n * sizeof(T), Alignment);
+    }
+
+    friend bool operator==(const CacheAlignedAllocator&, const CacheAlignedAllocator&) noexcept {
+        return true;
+    }
+};
+
+// A sorted sequence stored in Eytzinger (breadth-first) order: the root at index 1 and the children of
+// k at 2k and 2k + 1. A search walks down from the root, and the sixteen keys four levels below k sit at
+// 16k .. 16k + 15, so with cache-line aligned storage one prefetch covers every node the search can reach
+// four steps ahead. Lookups return a pointer into this layout, or nullptr when every key is less.
+template <typename T, typename Compare = std::less<>>
+class EytzingerArray {
+public:
+    EytzingerArray() = default;
+
+    template <typename InputIterator>
+    EytzingerArray(InputIterator first, InputIterator last, Compare comp = Compare()) : comp {comp} {
+        std::vector<T> sorted(first, last);
+        assert(std::is_sorted(sorted.begin(), sorted.end(), comp));
+        n = sorted.size();
+        keys.resize(n + 1);
+        size_t i = 0;
+        fill(sorted, i, 1);
+    }
+
+    size_t size() const noexcept {
+        return n;
+    }
 
+    const T* lowerBound(const T& value) const {
+        size_t k = 1;
+        while (k <= n) {
+            __builtin_prefetch(keys.data() + k * Prefetch);
+            k = 2 * k + comp(keys[k], value);
+        }
+        return found(k);
+    }
+
+    bool contains(const T& value) const {
+        const T* p = lowerBound(value);
+        return p && !comp(value, *p);
+    }
+
+    // Lockstep descent for Group queries at a time. Every level above the last is complete, so all
+    // searches take the same number of full steps and only the final one is conditional.
+    template <size_t Group = 16, typename QueryIterator, typename OutputIterator>
+    void lowerBoundBatch(QueryIterator queries, QueryIterator queriesLast, OutputIterator out) const {
+        size_t levels = std::bit_width(n);
+        while (queries != queriesLast) {
+            size_t m = std::min<size_t>(Group, static_cast<size_t>(std::distance(queries, queriesLast)));
+            size_t k[Group];
+            std::fill_n(k, m, 1);
+            for (size_t level = 1; level < levels; level++) {
+                for (size_t g = 0; g < m; g++) {
+                    __builtin_prefetch(keys.data() + k[g] * Prefetch);
+                    k[g] = 2 * k[g] + comp(keys[k[g]], queries[g]);
+                }
+            }
+            for (size_t g = 0; g < m; g++) {
+                if (k[g] <= n) {
+                    k[g] = 2 * k[g] + comp(keys[k[g]], queries[g]);
+                }
+                *out++ = found(k[g]);
+            }
+            std::advance(queries, m);
+        }
+    }
+
+private:
+    static constexpr size_t Prefetch = 64 / sizeof(T) > 1 ? std::bit_floor(64 / sizeof(T)) : 1;
+
+    std::vector<T, CacheAlignedAllocator<T>> keys;
+    size_t n = 0;
+    [[no_unique_address]] Compare comp;
+
+    void fill(const std::vector<T>& sorted, size_t& i, size_t k) {
+        if (k <= n) {
+            fill(sorted, i, 2 * k);
+            keys[k] = sorted[i++];
+            fill(sorted, i, 2 * k + 1);
+        }
+    }
+
+    // The search went right at every node whose key was less and left at the answer; undoing the
+    // trailing right turns and the last left turn gives the answer's index, or 0 if there is none.
+    const T* found(size_t k) const noexcept {
+        k >>= std::countr_one(k) + 1;
+        return k == 0 ? nullptr : keys.data() + k;
+    }
+};
+
+// Times f, which answers queries lookups, in nanoseconds per lookup.
+template <typename F>
+double nsPerLookup(size_t queries, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    f();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t2 - t1).count() / static_cast<double>(queries);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> small {1, 2, 3, 5, 8, 13, 21};
+    for (int x = 0; x <= 22; x++) {
+        auto expected = std::lower_bound(small.begin(), small.end(), x);
+        assert(LowerBound(small.begin(), small.end(), x, std::less<>()) == expected);
+        assert(BranchlessLowerBound(small.begin(), small.end(), x, std::less<>()) == expected);
+        assert(::lower_bound(small.begin(), small.end(), x) == expected);
+        assert(::binary_search(small.begin(), small.end(), x) == std::binary_search(small.begin(), small.end(), x));
+        for (size_t len = 0; len <= small.size(); len++) {
+            EytzingerArray<int> e(small.begin(), small.begin() + static_cast<std::ptrdiff_t>(len));
+            auto it = std::lower_bound(small.begin(), small.begin() + static_cast<std::ptrdiff_t>(len), x);
+            const int* p = e.lowerBound(x);
+            assert(it == small.begin() + static_cast<std::ptrdiff_t>(len) ? !p : p && *p == *it);
+        }
+    }
+    static_assert([] {
+        std::array<int, 3> a {1, 3, 5};
+        return *BranchlessLowerBound(a.begin(), a.end(), 4, std::less<>());
+    }() == 5);
+
+    // Searches n sorted even numbers with random queries, half of which hit. Pass a larger limit than the
+    // default 100M elements to go up to 1B; the arrays then need about 12 bytes per element.
+    size_t maxN = argc > 1 ? std::stoull(argv[1]) : 100'000'000;
+    constexpr size_t Queries = 1 << 22;
+    std::mt19937_64 gen(std::random_device{}());
+    for (size_t n = 1'000'000; n <= maxN; n *= 10) {
+        std::vector<int> v(n);
+        for (size_t i = 0; i < n; i++) {
+            v[i] = static_cast<int>(2 * i);
+        }
+        EytzingerArray<int> e(v.begin(), v.end());
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(2 * n));
+        std::vector<int> queries(Queries);
+        for (auto& q : queries) {
+            q = dist(gen);
+        }
+        auto valueOf = [&](std::vector<int>::const_iterator it) { return it == v.cend() ? -1 : *it; };
+        auto valueAt = [](const int* p) { return p ? *p : -1; };
+        std::vector<long long> sums;
+        std::cout << n << " elements, ns per lookup\n";
+        auto report = [&](const char* name, auto search) {
+            long long sum = 0;
+            double ns = nsPerLookup(Queries, [&] { sum = search(); });
+            sums.push_back(sum);
+            std::cout << "  " << name << " : " << ns << "\n";
+        };
+        report("std::ranges::lower_bound", [&] {
+            long long sum = 0;
+            for (int q : queries) {
+                sum += valueOf(std::ranges::lower_bound(v, q));
+            }
+            return sum;
+        });
+        report("LowerBound", [&] {
+            long long sum = 0;
+            for (int q : queries) {
+                sum += valueOf(LowerBound(v.cbegin(), v.cend(), q, std::less<>()));
+            }
+            return sum;
+        });
+        report("BranchlessLowerBound", [&] {
+            long long sum = 0;
+            for (int q : queries) {
+                sum += valueOf(BranchlessLowerBound(v.cbegin(), v.cend(), q, std::less<>()));
+            }
+            return sum;
+        });
+        report("LowerBoundBatch", [&] {
+            std::vector<std::vector<int>::const_iterator> out(Queries);
+            LowerBoundBatch(v.cbegin(), v.cend(), queries.begin(), queries.end(), out.begin(), std::less<>());
+            long long sum = 0;
+            for (auto it : out) {
+                sum += valueOf(it);
+            }
+            return sum;
+        });
+        report("EytzingerArray::lowerBound", [&] {
+            long long sum = 0;
+            for (int q : queries) {
+                sum += valueAt(e.lowerBound(q));
+            }
+            return sum;
+        });
+        report("EytzingerArray::lowerBoundBatch", [&] {
+            std::vector<const int*> out(Queries);
+            e.lowerBoundBatch(queries.begin(), queries.end(), out.begin());
+            long long sum = 0;
+            for (const int* p : out) {
+                sum += valueAt(p);
+            }
+            return sum;
+        });
+        assert(std::all_of(sums.begin(), sums.end(), [&](long long s) { return s == sums.front(); }));
+    }
 }
\ No newline at end of file
@@ -1,10 +1,71 @@
 #include <algorithm>
+#include <bit>
+#include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <random>
 #include <ranges>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
+#include "Sort.h"
+
+enum class Input { Random, Sorted, Duplicates };
+
+const char* inputName(Input input) {
+    switch (input) {
+        case Input::Random:
+            return "random";
+        case Input::Sorted:
+            return "sorted";
+        case Input::Duplicates:
+            return "16 distinct";
+    }
+    return "";
+}
+
+template <typename Gen>
+std::vector<double> makeInput(Input input, std::size_t n, Gen& gen) {
+    std::uniform_real_distribution<> dist(0.0, 10000.0);
+    std::uniform_int_distribution<> few(0, 15);
+    std::vector<double> v(n);
+    for (auto& x : v) {
+        x = input == Input::Duplicates ? few(gen) * 625.0 : dist(gen);
+    }
+    if (input == Input::Sorted) {
+        std::sort(v.begin(), v.end());
+    }
+    return v;
+}
+
+// Asserts that v is sorted and holds the keys of input bit for bit; == alone would take -0.0 for 0.0.
+template <typename T>
+void checkSort(const std::vector<T>& input, const std::vector<T>& v) {
+    using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+    auto bits = [](const std::vector<T>& keys) {
+        std::vector<Bits> b(keys.size());
+        std::ranges::transform(keys, b.begin(), [](T x) { return std::bit_cast<Bits>(x); });
+        std::ranges::sort(b);
+        return b;
+    };
+    assert(std::ranges::is_sorted(v) && bits(v) == bits(input));
+}
+
+// Sorts a copy of input, checks the result, and prints the throughput in millions of keys per second.
+template <typename T, typename Sort>
+void sortBenchmark(const char* name, const std::vector<T>& input, Sort sort) {
+    std::vector<T> v = input;
+    auto t1 = std::chrono::steady_clock::now();
+    sort(v.begin(), v.end());
+    auto t2 = std::chrono::steady_clock::now();
+    checkSort(input, v);
+    double s = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "  " << name << " : " << input.size() / s / 1e6 << " Mkeys/s\n";
+}
+
 int main() {
     std::mt19937 gen(std::random_device{}());
     std::uniform_real_distribution<> dist(0.0, 10000.0);
@@ -36,4 +97,39 @@ int main() {
     d1 = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
     std::cout << d1.count() << "ms\n";
 
+    // Keys that compare equal but differ in bits: every sort must keep both -0.0 and 0.0.
+    for (std::size_t n : {2, 5, 16, 17, 1'000, 100'000}) {
+        const double few[] = {-0.0, 0.0, -1.0, 1.0};
+        std::vector<double> keys(n);
+        for (auto& x : keys) {
+            x = few[gen() % 4];
+        }
+        auto check = [&keys](auto sort) {
+            std::vector<double> v = keys;
+            sort(v.begin(), v.end());
+            checkSort(keys, v);
+        };
+        check([](auto first, auto last) { introSort(first, last); });
+        check([](auto first, auto last) { radixSort(first, last); });
+        check([](auto first, auto last) { adaptiveSort(first, last); });
+        if (n <= NetworkSize) {
+            check([](auto first, auto last) { networkSort(first, last); });
+        }
+    }
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t n : {50'000, 500'000, 5'000'000}) {
+        for (Input input : {Input::Random, Input::Sorted, Input::Duplicates}) {
+            std::vector<double> keys = makeInput(input, n, gen);
+            std::cout << n << " " << inputName(input) << " doubles\n";
+            sortBenchmark("std::ranges::sort", keys, [](auto first, auto last) { std::ranges::sort(first, last); });
+            sortBenchmark("introSort", keys, [](auto first, auto last) { introSort(first, last); });
+            sortBenchmark("radixSort", keys, [](auto first, auto last) { radixSort(first, last); });
+            sortBenchmark("sampleSort", keys, [threads](auto first, auto last) {
+                sampleSort(first, last, std::less<>(), threads, [](auto lo, auto hi) { radixSort(lo, hi); });
+            });
+            sortBenchmark("adaptiveSort", keys, [](auto first, auto last) { adaptiveSort(first, last); });
+        }
+    }
+
 }
\ No newline at end of file
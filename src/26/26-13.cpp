@@ -1,12 +1,72 @@
 #include <algorithm>
+#include <cassert>
 #include <chrono>
+#include <functional>
 #include <iostream>
 #include <random>
 #include <ranges>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "Sort.h"
+
+enum class Input { Random, Sorted, Duplicates };
+
+const char* inputName(Input input) {
+    switch (input) {
+        case Input::Random:
+            return "random";
+        case Input::Sorted:
+            return "sorted";
+        case Input::Duplicates:
+            return "16 distinct";
+    }
+    return "";
+}
+
+// Random lowercase strings of 1 to 100 characters, as in main.
+template <typename Gen>
+std::vector<std::string> makeInput(Input input, std::size_t n, Gen& gen) {
+    std::uniform_int_distribution<> len_dist(1, 100);
+    std::uniform_int_distribution<> char_dist(0, 25);
+    std::vector<std::string> pool(input == Input::Duplicates ? 16 : n);
+    for (auto& s : pool) {
+        std::size_t len = len_dist(gen);
+        for (std::size_t j = 0; j < len; j++) {
+            s.push_back(static_cast<char>('a' + char_dist(gen)));
+        }
+    }
+    if (input != Input::Duplicates) {
+        if (input == Input::Sorted) {
+            std::sort(pool.begin(), pool.end());
+        }
+        return pool;
+    }
+    std::uniform_int_distribution<std::size_t> pick(0, pool.size() - 1);
+    std::vector<std::string> v(n);
+    for (auto& s : v) {
+        s = pool[pick(gen)];
+    }
+    return v;
+}
+
+// Sorts a copy of input, checks it against std::ranges::sort, and prints the throughput in millions
+// of keys per second.
+template <typename T, typename Sort>
+void sortBenchmark(const char* name, const std::vector<T>& input, Sort sort) {
+    std::vector<T> v = input;
+    auto t1 = std::chrono::steady_clock::now();
+    sort(v.begin(), v.end());
+    auto t2 = std::chrono::steady_clock::now();
+    std::vector<T> expected = input;
+    std::ranges::sort(expected);
+    assert(v == expected);
+    double s = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "  " << name << " : " << input.size() / s / 1e6 << " Mkeys/s\n";
+}
+
 int main() {
     std::mt19937 gen(std::random_device{}());
     std::uniform_real_distribution<> dist(0.0, 10000.0);
@@ -82,4 +142,18 @@ int main() {
     d1 = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
     std::cout << d1.count() << "ms\n";
 
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t n : {50'000, 500'000}) {
+        for (Input input : {Input::Random, Input::Sorted, Input::Duplicates}) {
+            std::vector<std::string> keys = makeInput(input, n, gen);
+            std::cout << n << " " << inputName(input) << " strings\n";
+            sortBenchmark("std::ranges::sort", keys, [](auto first, auto last) { std::ranges::sort(first, last); });
+            sortBenchmark("introSort", keys, [](auto first, auto last) { introSort(first, last); });
+            sortBenchmark("sampleSort", keys, [threads](auto first, auto last) {
+                sampleSort(first, last, std::less<>(), threads, [](auto lo, auto hi) { std::sort(lo, hi); });
+            });
+            sortBenchmark("adaptiveSort", keys, [](auto first, auto last) { adaptiveSort(first, last); });
+        }
+    }
+
 }
\ No newline at end of file
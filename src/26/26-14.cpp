@@ -1,9 +1,103 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <set>
 #include <random>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "BPlusTree.h"
+
+// Times inserting keys one by one, finding each of them, and an in-order scan.
+template <typename Set, typename Key>
+void setBenchmark(const char* name, const std::vector<Key>& keys) {
+    Set s;
+    auto t1 = std::chrono::steady_clock::now();
+    for (const auto& k : keys) {
+        s.insert(k);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (const auto& k : keys) {
+        found += s.find(k) != s.end();
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    size_t scanned = 0;
+    for (auto it = s.begin(); it != s.end(); ++it) {
+        scanned++;
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    assert(found == keys.size() && scanned == s.size());
+    auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << name << " " << keys.size() << " keys : insert " << ms(t2 - t1) << "ms, find " << ms(t3 - t2)
+              << "ms, scan " << ms(t4 - t3) << "ms\n";
+}
+
+// Builds from already sorted keys: std::set through end hints, the B+-tree through assign_sorted.
+template <typename Key>
+void bulkLoadBenchmark(const char* name, std::vector<Key> keys) {
+    std::sort(keys.begin(), keys.end());
+    auto t1 = std::chrono::steady_clock::now();
+    std::set<Key> s(keys.begin(), keys.end());
+    auto t2 = std::chrono::steady_clock::now();
+    BPlusSet<Key> b;
+    b.assign_sorted(keys.begin(), keys.end());
+    auto t3 = std::chrono::steady_clock::now();
+    assert(b.size() == s.size() && std::equal(b.begin(), b.end(), s.begin()));
+    auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << name << " " << keys.size() << " sorted keys : std::set " << ms(t2 - t1) << "ms, BPlusSet::assign_sorted "
+              << ms(t3 - t2) << "ms\n";
+}
+
+// Random inserts and deletes against std::set, checking the tree's invariants along the way.
+// key maps a number in [0, 5000] to a key of the set.
+template <typename Set, typename MakeKey>
+void randomizedTest(std::mt19937& gen, MakeKey key) {
+    using Key = typename Set::key_type;
+    Set b;
+    std::set<Key> s;
+    std::uniform_int_distribution<int32_t> key_dist(0, 5000);
+    for (std::size_t i = 0; i < 100'000; i++) {
+        Key k = key(key_dist(gen));
+        if (i % 3 == 2) {
+            assert(b.erase(k) == s.erase(k));
+        } else if (i % 3 == 1) {
+            assert(b.emplace(k).second == s.emplace(k).second);
+        } else {
+            assert(b.insert(k).second == s.insert(k).second);
+        }
+    }
+    assert(b.verify() && std::equal(b.begin(), b.end(), s.begin(), s.end()));
+    Key mid = key(2500);
+    assert(*b.lower_bound(mid) == *s.lower_bound(mid) && *std::prev(b.end()) == *s.rbegin());
+    for (int32_t n = 0; n <= 5000; n += 7) {
+        assert((b.find(key(n)) != b.end()) == s.contains(key(n)));
+        auto [first, last] = b.equal_range(key(n));
+        auto [sFirst, sLast] = s.equal_range(key(n));
+        assert(std::distance(first, last) == std::distance(sFirst, sLast) && (first == b.end()) == (sFirst == s.end()));
+        assert(first == b.end() || *first == *sFirst);
+    }
+    // Erasing by iterator every other key, which walks the successor across merged and rebalanced leaves.
+    for (auto it = b.begin(), sIt = s.begin(); it != b.end(); ++it, ++sIt) {
+        it = b.erase(it);
+        sIt = s.erase(sIt);
+        assert((it == b.end()) == (sIt == s.end()) && (it == b.end() || *it == *sIt));
+        if (it == b.end()) {
+            break;
+        }
+    }
+    assert(b.verify() && std::equal(b.begin(), b.end(), s.begin(), s.end()));
+}
 
 int main() {
     std::mt19937 gen(std::random_device{}());
@@ -70,4 +164,50 @@ int main() {
     d1 = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
     std::cout << d1.count() << "ms\n";
 
+    // The SIMD search over int and NaN-padded double keys, also with nodes narrower than the SIMD window,
+    // and the std::lower_bound search over strings.
+    {
+        randomizedTest<BPlusSet<int32_t>>(gen, [](int32_t n) { return n; });
+        randomizedTest<BPlusSet<double>>(gen, [](int32_t n) { return n * 0.5; });
+        randomizedTest<BPlusSet<double, std::less<double>, 128>>(gen, [](int32_t n) { return n * 0.5; });
+        randomizedTest<BPlusSet<std::string>>(gen, [](int32_t n) { return std::to_string(n); });
+        BPlusMap<std::string, int> m;
+        m["b"] = 2;
+        m["a"] = 1;
+        assert(m.try_emplace("c", 3).second && !m.try_emplace("a", 0).second && m.at("a") == 1);
+        int sum = 0;
+        for (auto [k, n] : m) {
+            sum += n;
+        }
+        assert(sum == 6 && m.begin()->first == "a");
+        assert(m.emplace("d", 4).second && !m.emplace("b", 0).second && m.at("b") == 2);
+        auto it = m.erase(m.find("b"));
+        assert(it->first == "c" && m.size() == 3 && !m.contains("b") && m.equal_range("b").first == it);
+    }
+
+    for (std::size_t n : {50'000, 500'000}) {
+        std::vector<double> keys(n);
+        for (auto& k : keys) {
+            k = dist(gen);
+        }
+        setBenchmark<std::set<double>>("std::set<double>", keys);
+        setBenchmark<BPlusSet<double>>("BPlusSet<double>", keys);
+        setBenchmark<BPlusSet<double, std::less<double>, 4096>>("BPlusSet<double, 4 KB nodes>", keys);
+        bulkLoadBenchmark("double", keys);
+    }
+
+    for (std::size_t n : {50'000, 500'000}) {
+        std::vector<std::string> keys(n);
+        for (auto& s : keys) {
+            std::size_t len = len_dist(gen);
+            for (std::size_t j = 0; j < len; j++) {
+                s.push_back(chars[char_dist(gen)]);
+            }
+        }
+        setBenchmark<std::set<std::string>>("std::set<std::string>", keys);
+        setBenchmark<BPlusSet<std::string>>("BPlusSet<std::string>", keys);
+        setBenchmark<BPlusSet<std::string, std::less<std::string>, 1024>>("BPlusSet<std::string, 1 KB nodes>", keys);
+        bulkLoadBenchmark("std::string", keys);
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,899 @@
+#ifndef PPP_BPLUSTREE_H
+#define PPP_BPLUSTREE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Whether BPlusTree searches a node's keys with SIMD compares: arithmetic keys ordered by std::less,
+// with the unused key slots padded by a value that no compare counts (NaN, or the largest integer).
+template <typename Key, typename Compare>
+inline constexpr bool simdKeys = (std::is_same_v<Key, double> || std::is_same_v<Key, float> || std::is_same_v<Key, int32_t>) &&
+                                 (std::is_same_v<Compare, std::less<Key>> || std::is_same_v<Compare, std::less<>>);
+
+template <typename Key>
+constexpr Key paddingKey() noexcept {
+    if constexpr (std::is_floating_point_v<Key>) {
+        return std::numeric_limits<Key>::quiet_NaN();
+    } else {
+        return std::numeric_limits<Key>::max();
+    }
+}
+
+// Counts the keys of keys[0, Window) that are less than x (OrEqual: not greater than x).
+// Padding is never less than anything; NaN padding is not less-or-equal to anything either.
+template <typename Key, size_t Window, bool OrEqual>
+size_t countWindow(const Key* keys, Key x) noexcept {
+    size_t n = 0;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<Key, double>) {
+        __m256d v = _mm256_set1_pd(x);
+        for (size_t i = 0; i < Window; i += 4) {
+            __m256d k = _mm256_loadu_pd(keys + i);
+            n += static_cast<size_t>(__builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(k, v, OrEqual ? _CMP_LE_OQ : _CMP_LT_OQ))));
+        }
+        return n;
+    } else if constexpr (std::is_same_v<Key, float>) {
+        __m256 v = _mm256_set1_ps(x);
+        for (size_t i = 0; i < Window; i += 8) {
+            __m256 k = _mm256_loadu_ps(keys + i);
+            n += static_cast<size_t>(__builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(k, v, OrEqual ? _CMP_LE_OQ : _CMP_LT_OQ))));
+        }
+        return n;
+    } else if constexpr (std::is_same_v<Key, int32_t>) {
+        __m256i v = _mm256_set1_epi32(x);
+        for (size_t i = 0; i < Window; i += 8) {
+            __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+            __m256i m = OrEqual ? _mm256_cmpgt_epi32(k, v) : _mm256_cmpgt_epi32(v, k);
+            size_t bits = static_cast<size_t>(__builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m))));
+            n += OrEqual ? 8 - bits : bits;
+        }
+        return n;
+    }
+#elif defined(__SSE2__)
+    if constexpr (std::is_same_v<Key, double>) {
+        __m128d v = _mm_set1_pd(x);
+        for (size_t i = 0; i < Window; i += 2) {
+            __m128d k = _mm_loadu_pd(keys + i);
+            n += static_cast<size_t>(__builtin_popcount(_mm_movemask_pd(OrEqual ? _mm_cmple_pd(k, v) : _mm_cmplt_pd(k, v))));
+        }
+        return n;
+    } else if constexpr (std::is_same_v<Key, float>) {
+        __m128 v = _mm_set1_ps(x);
+        for (size_t i = 0; i < Window; i += 4) {
+            __m128 k = _mm_loadu_ps(keys + i);
+            n += static_cast<size_t>(__builtin_popcount(_mm_movemask_ps(OrEqual ? _mm_cmple_ps(k, v) : _mm_cmplt_ps(k, v))));
+        }
+        return n;
+    } else if constexpr (std::is_same_v<Key, int32_t>) {
+        __m128i v = _mm_set1_epi32(x);
+        for (size_t i = 0; i < Window; i += 4) {
+            __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+            __m128i m = OrEqual ? _mm_cmpgt_epi32(k, v) : _mm_cmplt_epi32(k, v);
+            size_t bits = static_cast<size_t>(__builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(m))));
+            n += OrEqual ? 4 - bits : bits;
+        }
+        return n;
+    }
+#endif
+    for (size_t i = 0; i < Window; ++i) {
+        n += OrEqual ? keys[i] <= x : keys[i] < x;
+    }
+    return n;
+}
+
+// Ordered container on a B+-tree. Inner nodes hold only separator keys and child pointers, so a
+// NodeBytes-sized node fans out widely; all elements sit in the leaves, which are chained both ways
+// for range iteration. Nodes are cache-line aligned; pick NodeBytes of a few cache lines for lookups
+// or of a page for scans and bulk work.
+// Within a node, arithmetic keys under std::less are found by a branchless binary search over the
+// padded key slots down to a two-cache-line window, which is then counted with SIMD compares; other
+// keys use std::lower_bound. BPlusSet and BPlusMap follow std::set and std::map, except that any
+// insertion or erasure invalidates iterators, and map iterators yield std::pair<const Key&, T&> by value.
+template <typename Key, typename Mapped, typename Compare = std::less<Key>, size_t NodeBytes = 256>
+class BPlusTree {
+    static constexpr bool IsMap = !std::is_void_v<Mapped>;
+    static constexpr bool Simd = simdKeys<Key, Compare>;
+    // Key slots are padded to whole 32-byte vectors; the final SIMD count covers up to two cache lines.
+    static constexpr size_t Lane = Simd ? 32 / sizeof(Key) : 1;
+    static constexpr size_t Window = Simd ? 128 / sizeof(Key) : 1;
+    static constexpr size_t MaxDepth = 64;
+
+    static constexpr size_t roundUp(size_t n, size_t align) noexcept {
+        return (n + align - 1) / align * align;
+    }
+
+    static constexpr size_t slots(size_t cap) noexcept {
+        return roundUp(cap, Lane);
+    }
+
+    // Bytes of a node holding cap elements, laid out as Leaf and Inner below.
+    static constexpr size_t leafBytes(size_t cap) noexcept {
+        using M = std::conditional_t<IsMap, Mapped, char>;
+        size_t n = roundUp(sizeof(uint32_t) + sizeof(bool), alignof(Key)) + slots(cap) * sizeof(Key);
+        if (IsMap) {
+            n = roundUp(n, alignof(M)) + cap * sizeof(M);
+        }
+        return roundUp(roundUp(n, alignof(void*)) + 2 * sizeof(void*), 64);
+    }
+
+    static constexpr size_t innerBytes(size_t cap) noexcept {
+        size_t n = roundUp(sizeof(uint32_t) + sizeof(bool), alignof(Key)) + slots(cap) * sizeof(Key);
+        return roundUp(roundUp(n, alignof(void*)) + (cap + 1) * sizeof(void*), 64);
+    }
+
+    // The largest capacity whose padded node still fits NodeBytes, but never fewer than four elements.
+    template <typename Bytes>
+    static constexpr size_t capacity(Bytes bytes) noexcept {
+        size_t cap = 4;
+        while (bytes(cap + 1) <= NodeBytes) {
+            ++cap;
+        }
+        return cap;
+    }
+
+    static constexpr size_t LeafCap = capacity([](size_t cap) { return leafBytes(cap); });
+    static constexpr size_t InnerCap = capacity([](size_t cap) { return innerBytes(cap); });
+    static constexpr size_t LeafMin = LeafCap / 2;
+    static constexpr size_t InnerMin = InnerCap / 2;
+
+    struct Empty {};
+
+    struct NodeBase {
+        uint32_t count = 0;
+        bool leaf;
+
+        explicit NodeBase(bool leaf) : leaf {leaf} {}
+    };
+
+    struct alignas(64) Leaf : NodeBase {
+        Key keys[slots(LeafCap)];
+        [[no_unique_address]] std::conditional_t<IsMap, std::array<std::conditional_t<IsMap, Mapped, char>, LeafCap>, Empty> values;
+        Leaf* prev = nullptr;
+        Leaf* next = nullptr;
+
+        Leaf() : NodeBase(true) {
+            pad(keys, 0, slots(LeafCap));
+        }
+    };
+
+    struct alignas(64) Inner : NodeBase {
+        Key keys[slots(InnerCap)];
+        NodeBase* children[InnerCap + 1];
+
+        Inner() : NodeBase(false) {
+            pad(keys, 0, slots(InnerCap));
+        }
+    };
+
+    static_assert(!Simd || (sizeof(Leaf) <= NodeBytes && sizeof(Inner) <= NodeBytes),
+                  "NodeBytes is too small for four padded SIMD keys per node");
+
+public:
+    using key_type = Key;
+    using mapped_type = Mapped;
+    using value_type = std::conditional_t<IsMap, std::pair<Key, std::conditional_t<IsMap, Mapped, char>>, Key>;
+    using key_compare = Compare;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template <bool Const>
+    class Iterator {
+        using MappedRef = std::conditional_t<Const, const std::conditional_t<IsMap, Mapped, char>&, std::conditional_t<IsMap, Mapped, char>&>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = BPlusTree::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsMap, std::pair<const Key&, MappedRef>, const Key&>;
+
+        struct ArrowProxy {
+            reference r;
+
+            const reference* operator->() const noexcept {
+                return &r;
+            }
+        };
+
+        using pointer = std::conditional_t<IsMap, ArrowProxy, const Key*>;
+
+        Iterator() noexcept = default;
+
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        Iterator(const Iterator<false>& it) noexcept : tree {it.tree}, leaf {it.leaf}, i {it.i} {}
+
+        reference operator*() const noexcept {
+            if constexpr (IsMap) {
+                return reference(leaf->keys[i], leaf->values[i]);
+            } else {
+                return leaf->keys[i];
+            }
+        }
+
+        pointer operator->() const noexcept {
+            if constexpr (IsMap) {
+                return ArrowProxy {**this};
+            } else {
+                return &leaf->keys[i];
+            }
+        }
+
+        Iterator& operator++() noexcept {
+            if (++i == leaf->count) {
+                leaf = leaf->next;
+                i = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator t = *this;
+            ++*this;
+            return t;
+        }
+
+        Iterator& operator--() noexcept {
+            if (!leaf) {
+                leaf = tree->tail;
+                i = leaf->count;
+            } else if (i == 0) {
+                leaf = leaf->prev;
+                i = leaf->count;
+            }
+            --i;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator t = *this;
+            --*this;
+            return t;
+        }
+
+        friend bool operator==(const Iterator& x, const Iterator& y) noexcept {
+            return x.leaf == y.leaf && x.i == y.i;
+        }
+
+    private:
+        friend class BPlusTree;
+        template <bool> friend class Iterator;
+
+        const BPlusTree* tree = nullptr;
+        Leaf* leaf = nullptr;
+        size_t i = 0;
+
+        Iterator(const BPlusTree* tree, Leaf* leaf, size_t i) noexcept : tree {tree}, leaf {leaf}, i {i} {
+            if (leaf && i == leaf->count) {
+                this->leaf = leaf->next;
+                this->i = 0;
+            }
+        }
+    };
+
+    using iterator = std::conditional_t<IsMap, Iterator<false>, Iterator<true>>;
+    using const_iterator = Iterator<true>;
+
+    BPlusTree() = default;
+
+    explicit BPlusTree(const Compare& comp) : comp {comp} {}
+
+    template <typename InputIt>
+    BPlusTree(InputIt first, InputIt last, const Compare& comp = Compare()) : comp {comp} {
+        insert(first, last);
+    }
+
+    BPlusTree(std::initializer_list<value_type> init, const Compare& comp = Compare()) : BPlusTree(init.begin(), init.end(), comp) {}
+
+    BPlusTree(const BPlusTree& other) : comp {other.comp} {
+        assign_sorted(other.begin(), other.end());
+    }
+
+    BPlusTree(BPlusTree&& other) noexcept : root {other.root}, head {other.head}, tail {other.tail}, n {other.n}, comp {other.comp} {
+        other.root = nullptr;
+        other.head = other.tail = nullptr;
+        other.n = 0;
+    }
+
+    BPlusTree& operator=(BPlusTree other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~BPlusTree() {
+        clear();
+    }
+
+    void swap(BPlusTree& other) noexcept {
+        std::swap(root, other.root);
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(n, other.n);
+        std::swap(comp, other.comp);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, head, 0);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, head, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, nullptr, 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, nullptr, 0);
+    }
+
+    size_type size() const noexcept {
+        return n;
+    }
+
+    bool empty() const noexcept {
+        return n == 0;
+    }
+
+    key_compare key_comp() const {
+        return comp;
+    }
+
+    void clear() noexcept {
+        destroy(root);
+        root = nullptr;
+        head = tail = nullptr;
+        n = 0;
+    }
+
+    iterator lower_bound(const Key& key) {
+        Leaf* leaf = findLeaf(key);
+        return iterator(this, leaf, leaf ? leafLess(leaf, key) : 0);
+    }
+
+    const_iterator lower_bound(const Key& key) const {
+        return const_cast<BPlusTree*>(this)->lower_bound(key);
+    }
+
+    iterator upper_bound(const Key& key) {
+        Leaf* leaf = findLeaf(key);
+        return iterator(this, leaf, leaf ? leafLessEqual(leaf, key) : 0);
+    }
+
+    const_iterator upper_bound(const Key& key) const {
+        return const_cast<BPlusTree*>(this)->upper_bound(key);
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key& key) {
+        iterator it = lower_bound(key);
+        iterator last = it;
+        if (last != end() && !comp(key, keyOf(*last))) {
+            ++last;
+        }
+        return {it, last};
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+        auto [first, last] = const_cast<BPlusTree*>(this)->equal_range(key);
+        return {first, last};
+    }
+
+    iterator find(const Key& key) {
+        Leaf* leaf = findLeaf(key);
+        if (!leaf) {
+            return end();
+        }
+        size_t i = leafLess(leaf, key);
+        return i < leaf->count && !comp(key, leaf->keys[i]) ? iterator(this, leaf, i) : end();
+    }
+
+    const_iterator find(const Key& key) const {
+        return const_cast<BPlusTree*>(this)->find(key);
+    }
+
+    bool contains(const Key& key) const {
+        return find(key) != end();
+    }
+
+    size_type count(const Key& key) const {
+        return contains(key);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        if constexpr (IsMap) {
+            return emplaceUnique(value.first, value.second);
+        } else {
+            return emplaceUnique(value);
+        }
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        if constexpr (IsMap) {
+            return emplaceUnique(std::move(value.first), std::move(value.second));
+        } else {
+            return emplaceUnique(std::move(value));
+        }
+    }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    // Builds the value first: the key has to exist before the leaf it goes into can be found.
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    template <typename... Args, bool M = IsMap, typename = std::enable_if_t<M>>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return emplaceUnique(key, std::forward<Args>(args)...);
+    }
+
+    template <typename M = Mapped, typename = std::enable_if_t<!std::is_void_v<M>>>
+    M& operator[](const Key& key) {
+        return (*emplaceUnique(key).first).second;
+    }
+
+    template <typename M = Mapped, typename = std::enable_if_t<!std::is_void_v<M>>>
+    M& at(const Key& key) {
+        auto it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("BPlusTree::at");
+        }
+        return (*it).second;
+    }
+
+    size_type erase(const Key& key) {
+        Inner* path[MaxDepth];
+        size_t slot[MaxDepth];
+        size_t depth = 0;
+        Leaf* leaf = descend(key, path, slot, depth);
+        if (!leaf) {
+            return 0;
+        }
+        size_t i = leafLess(leaf, key);
+        if (i == leaf->count || comp(key, leaf->keys[i])) {
+            return 0;
+        }
+        removeFromLeaf(leaf, i);
+        n--;
+        if (depth == 0) {
+            if (leaf->count == 0) {
+                clear();
+            }
+        } else if (leaf->count < LeafMin) {
+            rebalanceLeaf(leaf, path, slot, depth);
+        }
+        return 1;
+    }
+
+    // Rebalancing may shift or merge the leaf, so the successor is found again from the erased key.
+    iterator erase(const_iterator pos) {
+        Key key = pos.leaf->keys[pos.i];
+        erase(key);
+        return lower_bound(key);
+    }
+
+    // Replaces the contents with an ascending range in linear time: leaves are filled evenly and
+    // inner levels built bottom-up from the first key of each subtree. Equal neighbours are dropped.
+    template <typename ForwardIt>
+    void assign_sorted(ForwardIt first, ForwardIt last) {
+        clear();
+        std::vector<ForwardIt> unique;
+        for (ForwardIt it = first, prev = last; it != last; prev = it++) {
+            if (prev == last || comp(keyOf(*prev), keyOf(*it))) {
+                unique.push_back(it);
+            }
+        }
+        if (unique.empty()) {
+            return;
+        }
+        size_t leaves = (unique.size() + LeafCap - 1) / LeafCap;
+        std::vector<std::pair<NodeBase*, Key>> level;
+        level.reserve(leaves);
+        size_t at = 0;
+        for (size_t l = 0; l < leaves; ++l) {
+            auto* leaf = new Leaf;
+            size_t take = unique.size() / leaves + (l < unique.size() % leaves);
+            for (size_t j = 0; j < take; ++j, ++at) {
+                leaf->keys[j] = keyOf(*unique[at]);
+                if constexpr (IsMap) {
+                    leaf->values[j] = (*unique[at]).second;
+                }
+            }
+            leaf->count = static_cast<uint32_t>(take);
+            leaf->prev = tail;
+            (tail ? tail->next : head) = leaf;
+            tail = leaf;
+            level.emplace_back(leaf, leaf->keys[0]);
+        }
+        while (level.size() > 1) {
+            size_t parents = (level.size() + InnerCap) / (InnerCap + 1);
+            std::vector<std::pair<NodeBase*, Key>> up;
+            up.reserve(parents);
+            at = 0;
+            for (size_t p = 0; p < parents; ++p) {
+                auto* inner = new Inner;
+                size_t take = level.size() / parents + (p < level.size() % parents);
+                for (size_t j = 0; j < take; ++j, ++at) {
+                    inner->children[j] = level[at].first;
+                    if (j > 0) {
+                        inner->keys[j - 1] = level[at].second;
+                    }
+                }
+                inner->count = static_cast<uint32_t>(take - 1);
+                up.emplace_back(inner, level[at - take].second);
+            }
+            level = std::move(up);
+        }
+        root = level.front().first;
+        n = unique.size();
+    }
+
+    // Checks ordering, fill, uniform depth and the leaf chain; for tests.
+    bool verify() const {
+        if (!root) {
+            return n == 0 && !head && !tail;
+        }
+        size_t leafDepth = 0;
+        size_t counted = 0;
+        const Leaf* prevLeaf = nullptr;
+        bool ok = verifyNode(root, 0, nullptr, nullptr, leafDepth, counted, prevLeaf);
+        return ok && counted == n && prevLeaf == tail;
+    }
+
+private:
+    NodeBase* root = nullptr;
+    Leaf* head = nullptr;
+    Leaf* tail = nullptr;
+    size_t n = 0;
+    [[no_unique_address]] Compare comp;
+
+    static void pad(Key* keys, size_t from, size_t to) noexcept {
+        if constexpr (Simd) {
+            std::fill(keys + from, keys + to, paddingKey<Key>());
+        }
+    }
+
+    template <typename V>
+    static const Key& keyOf(const V& v) noexcept {
+        if constexpr (IsMap) {
+            return v.first;
+        } else {
+            return v;
+        }
+    }
+
+    template <bool OrEqual, size_t Slots>
+    size_t search(const Key* keys, size_t count, const Key& key) const {
+        if constexpr (Simd) {
+            // Slots is a whole number of vectors, so a node narrower than the window is counted in one go.
+            constexpr size_t Span = std::min(Window, Slots);
+            size_t lo = 0;
+            size_t len = Slots;
+            while (len > Span) {
+                size_t half = len / 2;
+                bool right = OrEqual ? keys[lo + half] <= key : keys[lo + half] < key;
+                lo = right ? lo + half : lo;
+                len -= half;
+            }
+            size_t start = std::min(lo, Slots - Span);
+            return std::min(count, start + countWindow<Key, Span, OrEqual>(keys + start, key));
+        } else if constexpr (OrEqual) {
+            return static_cast<size_t>(std::upper_bound(keys, keys + count, key, comp) - keys);
+        } else {
+            return static_cast<size_t>(std::lower_bound(keys, keys + count, key, comp) - keys);
+        }
+    }
+
+    size_t innerIndex(const Inner* in, const Key& key) const {
+        return search<true, slots(InnerCap)>(in->keys, in->count, key);
+    }
+
+    size_t leafLess(const Leaf* leaf, const Key& key) const {
+        return search<false, slots(LeafCap)>(leaf->keys, leaf->count, key);
+    }
+
+    size_t leafLessEqual(const Leaf* leaf, const Key& key) const {
+        return search<true, slots(LeafCap)>(leaf->keys, leaf->count, key);
+    }
+
+    Leaf* descend(const Key& key, Inner** path, size_t* slot, size_t& depth) const {
+        NodeBase* node = root;
+        if (!node) {
+            return nullptr;
+        }
+        while (!node->leaf) {
+            auto* in = static_cast<Inner*>(node);
+            size_t c = innerIndex(in, key);
+            path[depth] = in;
+            slot[depth++] = c;
+            node = in->children[c];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    Leaf* findLeaf(const Key& key) const {
+        NodeBase* node = root;
+        if (!node) {
+            return nullptr;
+        }
+        while (!node->leaf) {
+            auto* in = static_cast<Inner*>(node);
+            node = in->children[innerIndex(in, key)];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> emplaceUnique(K&& key, Args&&... args) {
+        if (!root) {
+            root = head = tail = new Leaf;
+        }
+        Inner* path[MaxDepth];
+        size_t slot[MaxDepth];
+        size_t depth = 0;
+        Leaf* leaf = descend(key, path, slot, depth);
+        size_t i = leafLess(leaf, key);
+        if (i < leaf->count && !comp(key, leaf->keys[i])) {
+            return {iterator(this, leaf, i), false};
+        }
+        if (leaf->count == LeafCap) {
+            auto* right = new Leaf;
+            size_t keep = LeafCap / 2;
+            moveEntries(leaf, keep, right, 0, LeafCap - keep);
+            right->count = static_cast<uint32_t>(LeafCap - keep);
+            leaf->count = static_cast<uint32_t>(keep);
+            pad(leaf->keys, keep, slots(LeafCap));
+            right->next = leaf->next;
+            right->prev = leaf;
+            (leaf->next ? leaf->next->prev : tail) = right;
+            leaf->next = right;
+            insertIntoParent(path, slot, depth, right->keys[0], right);
+            if (i > keep) {
+                i -= keep;
+                leaf = right;
+            }
+        }
+        moveEntries(leaf, i, leaf, i + 1, leaf->count - i);
+        leaf->keys[i] = std::forward<K>(key);
+        if constexpr (IsMap) {
+            leaf->values[i] = std::conditional_t<IsMap, Mapped, char>(std::forward<Args>(args)...);
+        }
+        leaf->count++;
+        n++;
+        return {iterator(this, leaf, i), true};
+    }
+
+    // Moves count entries of from, starting at i, to position j of to; the ranges may overlap.
+    static void moveEntries(Leaf* from, size_t i, Leaf* to, size_t j, size_t count) {
+        if (from == to && j > i) {
+            std::move_backward(from->keys + i, from->keys + i + count, to->keys + j + count);
+            if constexpr (IsMap) {
+                std::move_backward(from->values.begin() + i, from->values.begin() + i + count, to->values.begin() + j + count);
+            }
+        } else {
+            std::move(from->keys + i, from->keys + i + count, to->keys + j);
+            if constexpr (IsMap) {
+                std::move(from->values.begin() + i, from->values.begin() + i + count, to->values.begin() + j);
+            }
+        }
+    }
+
+    // Adds separator and right after child slot[depth - 1] of path[depth - 1], splitting upwards as needed.
+    void insertIntoParent(Inner** path, size_t* slot, size_t depth, Key separator, NodeBase* right) {
+        while (true) {
+            if (depth == 0) {
+                auto* top = new Inner;
+                top->keys[0] = std::move(separator);
+                top->children[0] = root;
+                top->children[1] = right;
+                top->count = 1;
+                root = top;
+                return;
+            }
+            Inner* p = path[--depth];
+            size_t c = slot[depth];
+            if (p->count < InnerCap) {
+                std::move_backward(p->keys + c, p->keys + p->count, p->keys + p->count + 1);
+                std::move_backward(p->children + c + 1, p->children + p->count + 1, p->children + p->count + 2);
+                p->keys[c] = std::move(separator);
+                p->children[c + 1] = right;
+                p->count++;
+                return;
+            }
+            std::vector<Key> keys(std::make_move_iterator(p->keys), std::make_move_iterator(p->keys + InnerCap));
+            std::vector<NodeBase*> children(p->children, p->children + InnerCap + 1);
+            keys.insert(keys.begin() + static_cast<std::ptrdiff_t>(c), std::move(separator));
+            children.insert(children.begin() + static_cast<std::ptrdiff_t>(c + 1), right);
+            size_t mid = keys.size() / 2;
+            auto* q = new Inner;
+            std::move(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(mid), p->keys);
+            std::copy(children.begin(), children.begin() + static_cast<std::ptrdiff_t>(mid + 1), p->children);
+            p->count = static_cast<uint32_t>(mid);
+            pad(p->keys, mid, slots(InnerCap));
+            std::move(keys.begin() + static_cast<std::ptrdiff_t>(mid + 1), keys.end(), q->keys);
+            std::copy(children.begin() + static_cast<std::ptrdiff_t>(mid + 1), children.end(), q->children);
+            q->count = static_cast<uint32_t>(keys.size() - mid - 1);
+            separator = std::move(keys[mid]);
+            right = q;
+        }
+    }
+
+    void removeFromLeaf(Leaf* leaf, size_t i) {
+        moveEntries(leaf, i + 1, leaf, i, leaf->count - i - 1);
+        leaf->count--;
+        pad(leaf->keys, leaf->count, leaf->count + 1);
+    }
+
+    static void removeFromInner(Inner* in, size_t key, size_t child) {
+        std::move(in->keys + key + 1, in->keys + in->count, in->keys + key);
+        std::copy(in->children + child + 1, in->children + in->count + 1, in->children + child);
+        in->count--;
+        pad(in->keys, in->count, in->count + 1);
+    }
+
+    void rebalanceLeaf(Leaf* leaf, Inner** path, size_t* slot, size_t depth) {
+        Inner* p = path[depth - 1];
+        size_t c = slot[depth - 1];
+        Leaf* left = c > 0 ? static_cast<Leaf*>(p->children[c - 1]) : nullptr;
+        Leaf* right = c < p->count ? static_cast<Leaf*>(p->children[c + 1]) : nullptr;
+        if (left && left->count > LeafMin) {
+            moveEntries(leaf, 0, leaf, 1, leaf->count);
+            moveEntries(left, left->count - 1, leaf, 0, 1);
+            left->count--;
+            pad(left->keys, left->count, left->count + 1);
+            leaf->count++;
+            p->keys[c - 1] = leaf->keys[0];
+            return;
+        }
+        if (right && right->count > LeafMin) {
+            moveEntries(right, 0, leaf, leaf->count, 1);
+            leaf->count++;
+            removeFromLeaf(right, 0);
+            p->keys[c] = right->keys[0];
+            return;
+        }
+        if (left) {
+            mergeLeaves(left, leaf);
+            removeFromInner(p, c - 1, c);
+        } else {
+            mergeLeaves(leaf, right);
+            removeFromInner(p, c, c + 1);
+        }
+        rebalanceInner(path, slot, depth - 1);
+    }
+
+    // Appends right to left and frees right.
+    void mergeLeaves(Leaf* left, Leaf* right) {
+        moveEntries(right, 0, left, left->count, right->count);
+        left->count += right->count;
+        left->next = right->next;
+        (right->next ? right->next->prev : tail) = left;
+        delete right;
+    }
+
+    // path[k] may have underflowed.
+    void rebalanceInner(Inner** path, size_t* slot, size_t k) {
+        Inner* node = path[k];
+        if (k == 0) {
+            if (node->count == 0) {
+                root = node->children[0];
+                delete node;
+            }
+            return;
+        }
+        if (node->count >= InnerMin) {
+            return;
+        }
+        Inner* p = path[k - 1];
+        size_t c = slot[k - 1];
+        Inner* left = c > 0 ? static_cast<Inner*>(p->children[c - 1]) : nullptr;
+        Inner* right = c < p->count ? static_cast<Inner*>(p->children[c + 1]) : nullptr;
+        if (left && left->count > InnerMin) {
+            std::move_backward(node->keys, node->keys + node->count, node->keys + node->count + 1);
+            std::move_backward(node->children, node->children + node->count + 1, node->children + node->count + 2);
+            node->keys[0] = std::move(p->keys[c - 1]);
+            node->children[0] = left->children[left->count];
+            node->count++;
+            p->keys[c - 1] = std::move(left->keys[left->count - 1]);
+            left->count--;
+            pad(left->keys, left->count, left->count + 1);
+            return;
+        }
+        if (right && right->count > InnerMin) {
+            node->keys[node->count] = std::move(p->keys[c]);
+            node->children[node->count + 1] = right->children[0];
+            node->count++;
+            p->keys[c] = std::move(right->keys[0]);
+            removeFromInner(right, 0, 0);
+            return;
+        }
+        if (left) {
+            mergeInner(left, std::move(p->keys[c - 1]), node);
+            removeFromInner(p, c - 1, c);
+        } else {
+            mergeInner(node, std::move(p->keys[c]), right);
+            removeFromInner(p, c, c + 1);
+        }
+        rebalanceInner(path, slot, k - 1);
+    }
+
+    // Appends the separator and right's keys and children to left, then frees right.
+    static void mergeInner(Inner* left, Key separator, Inner* right) {
+        left->keys[left->count] = std::move(separator);
+        std::move(right->keys, right->keys + right->count, left->keys + left->count + 1);
+        std::copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+        left->count += right->count + 1;
+        delete right;
+    }
+
+    static void destroy(NodeBase* node) noexcept {
+        if (!node) {
+            return;
+        }
+        if (node->leaf) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        auto* in = static_cast<Inner*>(node);
+        for (size_t i = 0; i <= in->count; ++i) {
+            destroy(in->children[i]);
+        }
+        delete in;
+    }
+
+    bool verifyNode(const NodeBase* node, size_t depth, const Key* lo, const Key* hi, size_t& leafDepth, size_t& counted,
+                    const Leaf*& prevLeaf) const {
+        bool isRoot = node == root;
+        if (node->leaf) {
+            auto* leaf = static_cast<const Leaf*>(node);
+            if (leafDepth == 0) {
+                leafDepth = depth + 1;
+            }
+            bool ok = leafDepth == depth + 1 && leaf->prev == prevLeaf && (prevLeaf ? prevLeaf->next : head) == leaf &&
+                      leaf->count <= LeafCap && (isRoot || leaf->count >= LeafMin);
+            for (size_t i = 0; i < leaf->count; ++i) {
+                ok = ok && (i == 0 || comp(leaf->keys[i - 1], leaf->keys[i])) && (!lo || !comp(leaf->keys[i], *lo)) &&
+                     (!hi || comp(leaf->keys[i], *hi));
+            }
+            counted += leaf->count;
+            prevLeaf = leaf;
+            return ok;
+        }
+        auto* in = static_cast<const Inner*>(node);
+        bool ok = in->count <= InnerCap && (isRoot ? in->count >= 1 : in->count >= InnerMin);
+        for (size_t i = 0; ok && i <= in->count; ++i) {
+            const Key* childLo = i == 0 ? lo : &in->keys[i - 1];
+            const Key* childHi = i == in->count ? hi : &in->keys[i];
+            ok = (i == 0 || i == in->count || comp(in->keys[i - 1], in->keys[i])) &&
+                 verifyNode(in->children[i], depth + 1, childLo, childHi, leafDepth, counted, prevLeaf);
+        }
+        return ok;
+    }
+};
+
+template <typename Key, typename Compare = std::less<Key>, size_t NodeBytes = 256>
+using BPlusSet = BPlusTree<Key, void, Compare, NodeBytes>;
+
+template <typename Key, typename T, typename Compare = std::less<Key>, size_t NodeBytes = 256>
+using BPlusMap = BPlusTree<Key, T, Compare, NodeBytes>;
+
+#endif //PPP_BPLUSTREE_H
\ No newline at end of file
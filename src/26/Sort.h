@@ -0,0 +1,329 @@
+#ifndef PPP_SORT_H
+#define PPP_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Integer and floating-point keys sort by radix on an unsigned image of their bits.
+template <typename T>
+inline constexpr bool radixSortable = (std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_same_v<T, float> ||
+                                      std::is_same_v<T, double>;
+
+// Maps a key to an unsigned integer with the same order. Signed integers get their sign bit flipped;
+// floats get every bit flipped when negative (so larger magnitudes sort first) and only the sign bit otherwise.
+template <typename T>
+auto radixKey(T x) noexcept {
+    using U = std::make_unsigned_t<std::conditional_t<std::is_floating_point_v<T>, std::conditional_t<sizeof(T) == 4, int32_t, int64_t>, T>>;
+    constexpr U signBit = U(1) << (sizeof(U) * 8 - 1);
+    if constexpr (std::is_floating_point_v<T>) {
+        U bits = std::bit_cast<U>(x);
+        return (bits & signBit) ? U(~bits) : U(bits | signBit);
+    } else if constexpr (std::is_signed_v<T>) {
+        return U(static_cast<U>(x) ^ signBit);
+    } else {
+        return x;
+    }
+}
+
+// LSD radix sort on 8-bit digits. All digit histograms come from one read of the input, and a pass whose
+// digit is the same for every key is skipped, which is common for the high bytes of doubles in a narrow range.
+template <typename RandomIt>
+void radixSort(RandomIt first, RandomIt last) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    static_assert(radixSortable<T>);
+    constexpr size_t Passes = sizeof(T);
+    size_t n = static_cast<size_t>(last - first);
+    if (n < 2) {
+        return;
+    }
+    std::vector<std::array<size_t, 256>> counts(Passes);
+    for (auto it = first; it != last; ++it) {
+        auto key = radixKey(*it);
+        for (size_t p = 0; p < Passes; p++) {
+            counts[p][(key >> (8 * p)) & 0xff]++;
+        }
+    }
+    std::vector<T> buffer(n);
+    T* src = std::to_address(first);
+    T* dst = buffer.data();
+    for (size_t p = 0; p < Passes; p++) {
+        auto& count = counts[p];
+        if (std::find(count.begin(), count.end(), n) != count.end()) {
+            continue;
+        }
+        size_t offset = 0;
+        for (auto& c : count) {
+            offset += std::exchange(c, offset);
+        }
+        for (size_t i = 0; i < n; i++) {
+            dst[count[(radixKey(src[i]) >> (8 * p)) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != std::to_address(first)) {
+        std::copy(src, src + n, first);
+    }
+}
+
+inline constexpr size_t NetworkSize = 16;
+
+// One stage of a bitonic network: compare-exchanges a[i] with a[i + j], ascending where i & k is zero.
+// Within a block of j consecutive pairs the direction is fixed, so doubles and floats are exchanged a
+// whole SSE register at a time. A pair is swapped only when out of order, by a compare mask rather than
+// min and max, so keys that compare equal but differ in bits (-0.0 and 0.0) both survive.
+template <typename T>
+void bitonicStage(T* a, size_t k, size_t j) noexcept {
+    for (size_t b = 0; b < NetworkSize; b += 2 * j) {
+        bool up = (b & k) == 0;
+        size_t i = b;
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<T, double>) {
+            for (; i + 2 <= b + j; i += 2) {
+                __m128d x = _mm_loadu_pd(a + i);
+                __m128d y = _mm_loadu_pd(a + i + j);
+                __m128d swap = up ? _mm_cmplt_pd(y, x) : _mm_cmplt_pd(x, y);
+                _mm_storeu_pd(a + i, _mm_or_pd(_mm_and_pd(swap, y), _mm_andnot_pd(swap, x)));
+                _mm_storeu_pd(a + i + j, _mm_or_pd(_mm_and_pd(swap, x), _mm_andnot_pd(swap, y)));
+            }
+        } else if constexpr (std::is_same_v<T, float>) {
+            for (; i + 4 <= b + j; i += 4) {
+                __m128 x = _mm_loadu_ps(a + i);
+                __m128 y = _mm_loadu_ps(a + i + j);
+                __m128 swap = up ? _mm_cmplt_ps(y, x) : _mm_cmplt_ps(x, y);
+                _mm_storeu_ps(a + i, _mm_or_ps(_mm_and_ps(swap, y), _mm_andnot_ps(swap, x)));
+                _mm_storeu_ps(a + i + j, _mm_or_ps(_mm_and_ps(swap, x), _mm_andnot_ps(swap, y)));
+            }
+        }
+#endif
+        for (; i < b + j; i++) {
+            T x = a[i];
+            T y = a[i + j];
+            bool swap = up ? y < x : x < y;
+            a[i] = swap ? y : x;
+            a[i + j] = swap ? x : y;
+        }
+    }
+}
+
+// Sorts up to NetworkSize arithmetic keys without data-dependent branches: the keys are padded with the
+// largest value and run through all ten stages of a 16-key bitonic network.
+template <typename RandomIt>
+void networkSort(RandomIt first, RandomIt last) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    static_assert(std::is_arithmetic_v<T>);
+    size_t n = static_cast<size_t>(last - first);
+    assert(n <= NetworkSize);
+    T a[NetworkSize];
+    std::copy(first, last, a);
+    std::fill(a + n, a + NetworkSize, std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max());
+    for (size_t k = 2; k <= NetworkSize; k *= 2) {
+        for (size_t j = k / 2; j > 0; j /= 2) {
+            bitonicStage(a, k, j);
+        }
+    }
+    std::copy(a, a + n, first);
+}
+
+template <typename RandomIt, typename Compare>
+void insertionSort(RandomIt first, RandomIt last, Compare comp) {
+    for (auto it = first; it != last; ++it) {
+        auto x = std::move(*it);
+        auto j = it;
+        for (; j != first && comp(x, *(j - 1)); --j) {
+            *j = std::move(*(j - 1));
+        }
+        *j = std::move(x);
+    }
+}
+
+// Quicksort on a median-of-three pivot with Hoare partitioning, which splits runs of equal keys evenly.
+// Partitions of at most NetworkSize elements finish in networkSort when the keys are arithmetic and
+// ordered by std::less, and in insertion sort otherwise; too deep a recursion falls back to heapsort.
+template <typename RandomIt, typename Compare>
+void introSort(RandomIt first, RandomIt last, Compare comp, int depth) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    while (last - first > static_cast<std::ptrdiff_t>(NetworkSize)) {
+        if (depth-- == 0) {
+            std::make_heap(first, last, comp);
+            std::sort_heap(first, last, comp);
+            return;
+        }
+        RandomIt mid = first + (last - first) / 2;
+        if (comp(*mid, *first)) {
+            std::iter_swap(mid, first);
+        }
+        if (comp(*(last - 1), *mid)) {
+            std::iter_swap(last - 1, mid);
+            if (comp(*mid, *first)) {
+                std::iter_swap(mid, first);
+            }
+        }
+        T pivot = *mid;
+        RandomIt i = first;
+        RandomIt j = last - 1;
+        while (i <= j) {
+            while (comp(*i, pivot)) {
+                ++i;
+            }
+            while (comp(pivot, *j)) {
+                --j;
+            }
+            if (i <= j) {
+                std::iter_swap(i, j);
+                ++i;
+                --j;
+            }
+        }
+        if (j + 1 - first < last - i) {
+            introSort(first, j + 1, comp, depth);
+            first = i;
+        } else {
+            introSort(i, last, comp, depth);
+            last = j + 1;
+        }
+    }
+    if constexpr (std::is_arithmetic_v<T> && std::is_same_v<Compare, std::less<>>) {
+        networkSort(first, last);
+    } else {
+        insertionSort(first, last, comp);
+    }
+}
+
+template <typename RandomIt, typename Compare = std::less<>>
+void introSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    introSort(first, last, comp, 2 * std::bit_width(static_cast<size_t>(last - first)));
+}
+
+// Runs f(t) for t in [0, threads), on threads - 1 new threads and the caller.
+template <typename F>
+void parallelFor(unsigned threads, F f) {
+    std::vector<std::jthread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(f, t);
+    }
+    f(0u);
+}
+
+// Parallel sample sort. Sorted random samples give up to BucketsPerThread * threads splitters (duplicates
+// dropped, so heavy repeats collapse into few buckets); each thread then classifies and counts its slice,
+// everyone scatters into a buffer at exclusive offsets, buckets are claimed one at a time and finished by
+// sortBucket, and the buffer is moved back. Every phase touches each element once, without locks.
+template <typename RandomIt, typename Compare, typename BucketSort>
+void sampleSort(RandomIt first, RandomIt last, Compare comp, unsigned threads, BucketSort sortBucket) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    constexpr size_t BucketsPerThread = 4;
+    constexpr size_t Oversampling = 16;
+    size_t n = static_cast<size_t>(last - first);
+    size_t wanted = threads * BucketsPerThread;
+    if (threads < 2 || n < wanted * Oversampling) {
+        sortBucket(first, last);
+        return;
+    }
+    std::mt19937_64 gen(n);
+    std::vector<T> samples;
+    samples.reserve(wanted * Oversampling);
+    for (size_t i = 0; i < wanted * Oversampling; i++) {
+        samples.push_back(first[static_cast<std::ptrdiff_t>(gen() % n)]);
+    }
+    std::sort(samples.begin(), samples.end(), comp);
+    std::vector<T> splitters;
+    for (size_t i = 1; i < wanted; i++) {
+        const T& s = samples[i * Oversampling];
+        if (splitters.empty() || comp(splitters.back(), s)) {
+            splitters.push_back(s);
+        }
+    }
+    size_t buckets = splitters.size() + 1;
+    std::vector<uint32_t> bucketOf(n);
+    std::vector<size_t> offsets(threads * buckets);
+    auto slice = [n, threads](unsigned t) {
+        return std::pair(n * t / threads, n * (t + 1) / threads);
+    };
+    parallelFor(threads, [&](unsigned t) {
+        auto [lo, hi] = slice(t);
+        size_t* count = &offsets[t * buckets];
+        for (size_t i = lo; i < hi; i++) {
+            auto b = std::upper_bound(splitters.begin(), splitters.end(), first[static_cast<std::ptrdiff_t>(i)], comp) - splitters.begin();
+            bucketOf[i] = static_cast<uint32_t>(b);
+            count[b]++;
+        }
+    });
+    std::vector<size_t> bucketStart(buckets + 1);
+    size_t offset = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        bucketStart[b] = offset;
+        for (unsigned t = 0; t < threads; t++) {
+            offset += std::exchange(offsets[t * buckets + b], offset);
+        }
+    }
+    bucketStart[buckets] = n;
+    std::vector<T> buffer(n);
+    parallelFor(threads, [&](unsigned t) {
+        auto [lo, hi] = slice(t);
+        size_t* next = &offsets[t * buckets];
+        for (size_t i = lo; i < hi; i++) {
+            buffer[next[bucketOf[i]]++] = std::move(first[static_cast<std::ptrdiff_t>(i)]);
+        }
+    });
+    std::atomic<size_t> claimed {0};
+    parallelFor(threads, [&](unsigned) {
+        for (size_t b; (b = claimed.fetch_add(1, std::memory_order_relaxed)) < buckets;) {
+            auto lo = buffer.begin() + static_cast<std::ptrdiff_t>(bucketStart[b]);
+            auto hi = buffer.begin() + static_cast<std::ptrdiff_t>(bucketStart[b + 1]);
+            sortBucket(lo, hi);
+            std::move(lo, hi, first + static_cast<std::ptrdiff_t>(bucketStart[b]));
+        }
+    });
+}
+
+inline constexpr size_t RadixMinSize = 512;
+inline constexpr size_t ParallelMinSize = 1 << 18;
+
+// Picks a sort by key type and size after a linear check for already sorted input: sample sort across
+// hardware threads for large inputs, LSD radix sort for integer and floating-point keys under the
+// default order, introSort for everything else.
+template <typename RandomIt, typename Compare = std::less<>>
+void adaptiveSort(RandomIt first, RandomIt last, Compare comp = Compare()) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    constexpr bool Radix = radixSortable<T> && std::is_same_v<Compare, std::less<>> &&
+                           std::contiguous_iterator<RandomIt>;
+    auto sequential = [comp](auto lo, auto hi) {
+        if constexpr (Radix) {
+            if (static_cast<size_t>(hi - lo) >= RadixMinSize) {
+                radixSort(lo, hi);
+                return;
+            }
+        }
+        introSort(lo, hi, comp);
+    };
+    if (std::is_sorted(first, last, comp)) {
+        return;
+    }
+    size_t n = static_cast<size_t>(last - first);
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    if (n >= ParallelMinSize && threads > 1) {
+        sampleSort(first, last, comp, threads, sequential);
+    } else {
+        sequential(first, last);
+    }
+}
+
+#endif //PPP_SORT_H
\ No newline at end of file